@@ -0,0 +1,141 @@
+// Google Benchmark suite for the native kernels. Run per release to catch
+// performance regressions before they ship:
+//
+//   cmake -DSNAPIFY_BUILD_BENCH=ON .. && make snapify_bench && ./snapify_bench
+//
+// Covers the core operations, the frame wrap/extract marshaling, and the
+// SIMD kernels against scalar references, at thumbnail/1080p/4K sizes.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "image_core.h"
+#include "simd_kernels.h"
+
+namespace {
+
+// Deterministic synthetic frame so runs are comparable across machines
+cv::Mat makeFrame(int width, int height, int channels = 3) {
+    cv::Mat frame(height, width, channels == 1 ? CV_8UC1 : (channels == 4 ? CV_8UC4 : CV_8UC3));
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = frame.ptr<uint8_t>(y);
+        for (int x = 0; x < width * channels; ++x) {
+            row[x] = (uint8_t)((x * 7 + y * 13) & 0xFF);
+        }
+    }
+    return frame;
+}
+
+struct FrameSize {
+    const char* name;
+    int width;
+    int height;
+};
+
+constexpr FrameSize kSizes[] = {
+    {"256px", 256, 256},
+    {"1080p", 1920, 1080},
+    {"4k", 3840, 2160},
+};
+
+void BM_ProcessMat(benchmark::State& state, const char* operation) {
+    const FrameSize& size = kSizes[state.range(0)];
+    ImageCore core;
+    cv::Mat frame = makeFrame(size.width, size.height);
+
+    for (auto _ : state) {
+        cv::Mat result = core.processMat(frame, operation);
+        benchmark::DoNotOptimize(result.data);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * frame.total() * frame.elemSize());
+    state.SetLabel(size.name);
+}
+
+void BM_ProcessChainHdrTonemap(benchmark::State& state) {
+    const FrameSize& size = kSizes[state.range(0)];
+    ImageCore core;
+    cv::Mat frame = makeFrame(size.width, size.height);
+    std::vector<std::string> chain = {"hdr", "tone_mapping"};
+
+    for (auto _ : state) {
+        cv::Mat result = core.processChain(frame, chain);
+        benchmark::DoNotOptimize(result.data);
+    }
+    state.SetLabel(size.name);
+}
+
+void BM_WrapFrame(benchmark::State& state) {
+    const FrameSize& size = kSizes[state.range(0)];
+    ImageCore core;
+    std::vector<uint8_t> pixels((size_t)size.width * size.height * 3, 127);
+    ImageCore::FrameDescriptor desc;
+    desc.width = size.width;
+    desc.height = size.height;
+
+    for (auto _ : state) {
+        cv::Mat wrapped = core.wrapFrame(pixels.data(), desc);
+        benchmark::DoNotOptimize(wrapped.data);
+    }
+    state.SetLabel(size.name);
+}
+
+void BM_ExtractDataFromMat(benchmark::State& state) {
+    const FrameSize& size = kSizes[state.range(0)];
+    ImageCore core;
+    cv::Mat frame = makeFrame(size.width, size.height);
+
+    for (auto _ : state) {
+        ImageBuffer out = core.extractDataFromMat(frame);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * frame.total() * frame.elemSize());
+    state.SetLabel(size.name);
+}
+
+// --- SIMD kernels vs scalar references ---
+
+void scalarInvertReference(uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = 255 - data[i];
+    }
+}
+
+void BM_SimdInvert(benchmark::State& state) {
+    const FrameSize& size = kSizes[state.range(0)];
+    std::vector<uint8_t> pixels((size_t)size.width * size.height * 3, 127);
+    for (auto _ : state) {
+        simd::invert(pixels.data(), pixels.size());
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * pixels.size());
+    state.SetLabel(size.name);
+}
+
+void BM_ScalarInvert(benchmark::State& state) {
+    const FrameSize& size = kSizes[state.range(0)];
+    std::vector<uint8_t> pixels((size_t)size.width * size.height * 3, 127);
+    for (auto _ : state) {
+        scalarInvertReference(pixels.data(), pixels.size());
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * pixels.size());
+    state.SetLabel(size.name);
+}
+
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ProcessMat, invert, "invert")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, grayscale, "grayscale")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, hdr, "hdr")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, hdr_tiled, "hdr_tiled")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, tone_mapping, "tone_mapping")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, tone_mapping_tiled, "tone_mapping_tiled")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, edge_detection, "edge_detection")->DenseRange(0, 2);
+BENCHMARK_CAPTURE(BM_ProcessMat, encode_jpeg, "encode_jpeg")->DenseRange(0, 2);
+BENCHMARK(BM_ProcessChainHdrTonemap)->DenseRange(0, 2);
+BENCHMARK(BM_WrapFrame)->DenseRange(0, 2);
+BENCHMARK(BM_ExtractDataFromMat)->DenseRange(0, 2);
+BENCHMARK(BM_SimdInvert)->DenseRange(0, 2);
+BENCHMARK(BM_ScalarInvert)->DenseRange(0, 2);
+
+BENCHMARK_MAIN();
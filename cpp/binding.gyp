@@ -1,10 +1,59 @@
 {
   "targets": [
+    {
+      "target_name": "simd_avx2",
+      "type": "static_library",
+      "sources": [
+        "src/simd_kernels_avx2.cc"
+      ],
+      "include_dirs": [
+        "include"
+      ],
+      "cflags_cc": [
+        "-std=c++17"
+      ],
+      "conditions": [
+        ["target_arch=='x64' or target_arch=='ia32'", {
+          "cflags_cc": ["-mavx2"],
+          "xcode_settings": {
+            "OTHER_CPLUSPLUSFLAGS": ["-std=c++17", "-mavx2"]
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "simd_avx512",
+      "type": "static_library",
+      "sources": [
+        "src/simd_kernels_avx512.cc"
+      ],
+      "include_dirs": [
+        "include"
+      ],
+      "cflags_cc": [
+        "-std=c++17"
+      ],
+      "conditions": [
+        ["target_arch=='x64' or target_arch=='ia32'", {
+          "cflags_cc": ["-mavx512f", "-mavx512bw"],
+          "xcode_settings": {
+            "OTHER_CPLUSPLUSFLAGS": ["-std=c++17", "-mavx512f", "-mavx512bw"]
+          }
+        }]
+      ]
+    },
     {
       "target_name": "image_processor",
       "sources": [
         "src/binding.cc",
-        "src/image_processor.cc"
+        "src/image_processor.cc",
+        "src/image_core.cc",
+        "src/arena_allocator.cc",
+        "src/descriptor_index.cc",
+        "src/stage_timer.cc",
+        "src/simd_kernels.cc",
+        "src/simd_kernels_scalar.cc",
+        "src/simd_kernels_neon.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -12,7 +61,9 @@
         "<!@(pkg-config --cflags-only-I opencv4 | sed s/-I//g)"
       ],
       "dependencies": [
-        "<!(node -p \"require('node-addon-api').gyp\")"
+        "<!(node -p \"require('node-addon-api').gyp\")",
+        "simd_avx2",
+        "simd_avx512"
       ],
       "defines": [
         "NODE_ADDON_API_CPP_EXCEPTIONS"
@@ -22,9 +73,6 @@
       ],
       "cflags_cc": [
         "-std=c++17",
-        "-mavx",
-        "-mavx2",
-        "-mfma",
         "-frtti",
         "-fexceptions"
       ],
@@ -34,10 +82,7 @@
         "CLANG_CXX_LIBRARY": "libc++",
         "MACOSX_DEPLOYMENT_TARGET": "10.7",
         "OTHER_CPLUSPLUSFLAGS": [
-          "-std=c++17",
-          "-mavx",
-          "-mavx2",
-          "-mfma"
+          "-std=c++17"
         ]
       },
       "msvs_settings": {
@@ -48,4 +93,4 @@
       }
     }
   ]
-}
\ No newline at end of file
+}
@@ -0,0 +1,95 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Size-classed pooling allocator backing per-request pixel storage.
+//
+// Blocks are rounded up to power-of-two size classes and recycled through
+// thread-local free lists, so steady-state request processing stops hitting
+// glibc malloc entirely: a released Mat's storage is handed straight to the
+// next request of the same resolution class. Caches are trimmed back to a
+// byte budget between requests to cap fragmentation growth.
+class ArenaAllocator {
+public:
+    struct Stats {
+        uint64_t allocations = 0;
+        uint64_t pool_hits = 0;
+        uint64_t bytes_in_use = 0;
+    };
+
+    static ArenaAllocator& instance();
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+
+    // Releases cached blocks on the calling thread until the cache fits the
+    // budget; called between requests on the processing threads
+    void trimThreadCache(size_t budget_bytes = kDefaultCacheBudget);
+
+    Stats stats() const;
+
+    // Per-thread cached bytes allowed to survive a trim (~4 full 24 MP frames)
+    static constexpr size_t kDefaultCacheBudget = 256 * 1024 * 1024;
+
+private:
+    ArenaAllocator() = default;
+
+    static size_t sizeClassFor(size_t size);
+
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> pool_hits_{0};
+    std::atomic<uint64_t> bytes_in_use_{0};
+};
+
+// STL allocator over the arena, so containers holding pixel-sized payloads
+// recycle blocks the same way Mat storage does. Stateless: any instance can
+// free what another allocated.
+template <typename T>
+class ArenaStdAllocator {
+public:
+    using value_type = T;
+
+    ArenaStdAllocator() = default;
+    template <typename U>
+    ArenaStdAllocator(const ArenaStdAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(ArenaAllocator::instance().allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+        ArenaAllocator::instance().deallocate(ptr, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaStdAllocator<T>&, const ArenaStdAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const ArenaStdAllocator<T>&, const ArenaStdAllocator<U>&) { return false; }
+
+// Byte buffer for frame-sized conversion copies (Mat <-> boundary); storage
+// comes from the arena, so a buffer released by one request is reused by the
+// next request of the same resolution class
+using ImageBuffer = std::vector<uint8_t, ArenaStdAllocator<uint8_t>>;
+
+// cv::MatAllocator that routes Mat pixel storage through the arena. Installed
+// process-wide via installMatAllocator(); Mats keep their usual refcounting
+// semantics, storage just comes from (and returns to) the pool.
+class MatArenaAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0,
+                           size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags,
+                  cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData* u) const override;
+
+    // Installs the arena as the process-wide default Mat allocator (idempotent)
+    static void install();
+};
+
+#endif // ARENA_ALLOCATOR_H
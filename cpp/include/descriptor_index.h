@@ -0,0 +1,65 @@
+#ifndef DESCRIPTOR_INDEX_H
+#define DESCRIPTOR_INDEX_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/flann.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Approximate-nearest-neighbor index over ORB descriptors for duplicate and
+// near-duplicate detection. Descriptors are accumulated per image id and
+// searched through a FLANN LSH index (Hamming space), so a query is
+// sub-linear in the corpus size instead of the O(n^2) brute-force compare.
+//
+// The LSH index is rebuilt lazily on the first query after new additions —
+// bulk indexing jobs pay the build cost once, not per add. The raw
+// descriptor rows and their image ids persist to a flat binary file via
+// save()/load(); the LSH tables themselves are cheap to rebuild and are not
+// stored.
+class DescriptorIndex {
+public:
+    struct Match {
+        uint64_t image_id = 0;
+        uint32_t votes = 0; // query descriptors whose nearest neighbor is this image
+        double score = 0.0; // votes / query descriptor count
+    };
+
+    // Path of the on-disk index; empty disables persistence
+    void setPath(const std::string& path);
+
+    // Adds an image's descriptors (CV_8U, one per row) under the caller's
+    // id; returns the number of rows added
+    size_t add(uint64_t image_id, const cv::Mat& descriptors);
+
+    // Ranks indexed images by how many of the query's descriptors land on
+    // them within the Hamming radius, best first
+    std::vector<Match> queryNearest(const cv::Mat& descriptors, size_t max_results);
+
+    bool save();
+    bool load();
+
+    size_t imageCount() const;
+    size_t descriptorCount() const;
+
+private:
+    // Nearest neighbors farther than this many differing bits do not vote;
+    // ORB descriptors are 256 bits, matches below ~64 are near-certain
+    static constexpr int kMaxHammingDistance = 64;
+
+    void rebuildLocked();
+
+    mutable std::mutex mutex_;
+    std::string path_;
+    cv::Mat descriptors_;           // all indexed rows, CV_8U
+    std::vector<uint64_t> row_ids_; // owning image id per row
+    std::unordered_set<uint64_t> image_ids_;
+    std::unique_ptr<cv::flann::Index> index_;
+    bool dirty_ = false;
+};
+
+#endif // DESCRIPTOR_INDEX_H
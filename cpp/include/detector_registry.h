@@ -0,0 +1,50 @@
+#ifndef DETECTOR_REGISTRY_H
+#define DETECTOR_REGISTRY_H
+
+#include <opencv2/opencv.hpp>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Process-wide registry of feature detectors. Constructing ORB and
+// especially SIFT is expensive, so detectors are created lazily on the
+// first feature operation and shared by every ImageCore in the process —
+// a worker that never touches feature_detection pays nothing. The cv::Ptr
+// algorithms are stateless after construction and safe to share across
+// threads for detectAndCompute.
+class DetectorRegistry {
+public:
+    static DetectorRegistry& instance() {
+        static DetectorRegistry registry;
+        return registry;
+    }
+
+    // Returns the shared detector for "ORB" or "SIFT", constructing it on
+    // first use; null for unknown names
+    cv::Ptr<cv::Feature2D> detector(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = detectors_.find(name);
+        if (it != detectors_.end()) {
+            return it->second;
+        }
+        cv::Ptr<cv::Feature2D> created;
+        if (name == "ORB") {
+            created = cv::ORB::create();
+        } else if (name == "SIFT") {
+            created = cv::SIFT::create();
+        }
+        if (created) {
+            detectors_[name] = created;
+        }
+        return created;
+    }
+
+private:
+    DetectorRegistry() = default;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, cv::Ptr<cv::Feature2D>> detectors_;
+};
+
+#endif // DETECTOR_REGISTRY_H
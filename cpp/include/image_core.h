@@ -0,0 +1,202 @@
+#ifndef IMAGE_CORE_H
+#define IMAGE_CORE_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "arena_allocator.h"
+
+// Shared image-processing core used by both the N-API addon and the gRPC
+// service. All operation semantics live here so the same operation string
+// produces the same output (and the same performance) regardless of which
+// entry point a caller hits.
+class ImageCore {
+public:
+    // Frame geometry and pixel-format description for an incoming buffer.
+    // Defaults preserve the legacy 256x256 BGR contract.
+    struct FrameDescriptor {
+        int width = 256;
+        int height = 256;
+        int stride = 0;             // bytes per row of the first plane, 0 = tightly packed
+        // gray | bgr | rgb | bgra | rgba | nv12. rgb/rgba and nv12 frames are
+        // converted to canonical BGR(A) on ingest; processed output comes
+        // back in BGR(A)/gray order regardless of the input format.
+        std::string format = "bgr";
+    };
+
+    ImageCore();
+
+    // Frame descriptor handling
+    static int channelsForFormat(const std::string& format);
+    static size_t expectedFrameBytes(const FrameDescriptor& desc);
+    static bool isKnownFormat(const std::string& format);
+    static bool isCompressedFormat(const std::string& format);
+    cv::Mat wrapFrame(const uint8_t* data, const FrameDescriptor& desc);
+
+    // Codec stage. Compressed formats (jpeg/png/webp) go through OpenCV's
+    // imgcodecs, which binds the SIMD codecs (libjpeg-turbo, libwebp) — so
+    // callers can ship compressed bytes across the boundary instead of raw
+    // pixels. decodeFrame returns an empty Mat when decoding fails.
+    cv::Mat decodeFrame(const uint8_t* data, size_t length, const FrameDescriptor& desc);
+    std::vector<uint8_t> encodeImage(const cv::Mat& image, const std::string& format, int quality = 90);
+
+    // How processMat may use the input Mat's storage. kCopy (the default)
+    // never writes through the input; kInPlace lets elementwise operations
+    // (see isElementwise) compute their result in the input's own pixels,
+    // halving peak memory for those ops. Callers may pass kInPlace only for
+    // storage this request owns outright — never for caller-visible buffers
+    // or shared ring slots.
+    enum class ExecMode { kCopy, kInPlace };
+
+    // True for pixel-local operations whose output has the input's exact
+    // geometry and type (driven by the operation-traits table)
+    static bool isElementwise(const std::string& operation);
+
+    // Quality tier for a request. kBalanced is today's behavior; kFast
+    // substitutes preview-grade variants of the heavy operations (a 256-entry
+    // tone-curve LUT instead of TonemapReinhard, pyramid-downsampled Canny)
+    // that are several times cheaper; kBest spends more for archival output
+    // (Drago tone mapping, L2-gradient Canny). Operations without tiered
+    // variants run identically at every tier.
+    enum class Quality { kFast, kBalanced, kBest };
+
+    // Maps "fast" | "balanced" | "best" to a tier; empty means kBalanced and
+    // unknown names log and fall back to it
+    static Quality qualityFromName(const std::string& name);
+
+    // Runs one operation over a frame; under kCopy the returned Mat owns its
+    // storage unless the operation was a pure pass-through
+    cv::Mat processMat(const cv::Mat& input, const std::string& operation,
+                       ExecMode mode = ExecMode::kCopy,
+                       Quality quality = Quality::kBalanced);
+
+    // Runs an ordered list of operations as one native pipeline over shared
+    // intermediate Mats. Redundant stages are elided: tone_mapping applied to
+    // an already-HDR (float) intermediate skips recomputing the HDR pass.
+    // Intermediates materialized by earlier stages are owned by the chain, so
+    // elementwise stages after the first materialization run in place even
+    // under kCopy.
+    cv::Mat processChain(const cv::Mat& input, const std::vector<std::string>& operations,
+                         ExecMode mode = ExecMode::kCopy,
+                         Quality quality = Quality::kBalanced);
+
+    // True multi-exposure entry point: aligns the bracket with MTB (handheld
+    // captures are rarely pixel-aligned) and fuses it with MergeMertens, then
+    // runs the remaining operations over the fused frame. The fusion itself
+    // satisfies a leading "exposure_fusion" or "hdr" stage; the fused result
+    // is a float HDR-space Mat, so a following tone_mapping stage takes the
+    // direct path instead of recomputing an HDR pass.
+    cv::Mat processExposures(const std::vector<cv::Mat>& exposures,
+                             const std::vector<std::string>& operations,
+                             Quality quality = Quality::kBalanced);
+
+    // Processes an on-disk image wholly in native code: the source file is
+    // mmap'ed (no read-into-heap, no boundary copy), decoded or wrapped
+    // zero-copy, run through the operation chain, and the result written to
+    // out_path. Compressed sources are recognized by magic bytes; raw frame
+    // dumps need an explicit descriptor. The output codec follows out_path's
+    // extension (.jpg/.jpeg, .png, .webp) unless the chain already ended in
+    // an encode stage; other extensions get the raw pixel bytes. Returns
+    // false with error filled on failure.
+    bool processFile(const std::string& in_path, const std::vector<std::string>& operations,
+                     const std::string& out_path, std::string* error,
+                     const FrameDescriptor* raw_desc = nullptr);
+
+    // "jpeg", "png" or "webp" from a file's leading magic bytes; empty when
+    // unrecognized
+    static std::string sniffImageFormat(const uint8_t* data, size_t length);
+
+    // Legacy vector-based entry point (256x256 BGR contract)
+    ImageBuffer processImageData(const std::vector<uint8_t>& input, const std::string& operation);
+
+    // Copies a Mat's pixels into an arena-backed buffer, so repeated
+    // conversions of same-resolution frames recycle storage instead of
+    // round-tripping through malloc
+    ImageBuffer extractDataFromMat(const cv::Mat& mat);
+
+    // Resizes so the longer edge equals target_edge, preserving aspect.
+    // Downscales use area resampling, with a SIMD 2x2 box-filter halving
+    // fast path while both dimensions stay at least twice the target;
+    // upscales use Lanczos. Exposed through processMat as "resize_<edge>"
+    // (e.g. "resize_256").
+    cv::Mat resizeImage(const cv::Mat& input, int target_edge);
+
+    // Produces the thumbnail set for the given edge lengths from a single
+    // decode: sizes are generated largest-first, each from the previous
+    // (larger) result, so the full-resolution source is read exactly once.
+    // The returned Mats are in the same order as edges.
+    std::vector<cv::Mat> makeThumbnails(const cv::Mat& input, const std::vector<int>& edges);
+
+    // ORB descriptors for the descriptor index (CV_8U, one per row);
+    // empty when the frame has no usable features
+    cv::Mat extractDescriptors(const cv::Mat& input);
+
+    bool avxSupported() const;
+
+    // Instruction-set tier selected by the SIMD dispatcher at startup
+    // ("scalar", "sse2", "avx2", "avx512" or "neon")
+    static const char* simdTier();
+
+    // Execution backend for the heavy operations (HDR pipeline, Canny).
+    // "auto" (the default) runs them on OpenCL via the OpenCV transparent
+    // API when a device is present; "opencl" does the same but logs when no
+    // device is found; "cpu" forces the CPU path. Operations whose OpenCV
+    // implementation is CPU-only (MergeMertens, the Tonemap classes) always
+    // run on the CPU regardless of backend. Returns true when the GPU path
+    // is active.
+    bool setBackend(const std::string& name);
+    const char* activeBackend() const { return gpu_enabled_ ? "opencl" : "cpu"; }
+
+    // Per-backend operation counters for the heavy operations
+    struct BackendStats {
+        uint64_t gpu_ops = 0;
+        uint64_t cpu_ops = 0;
+        uint64_t gpu_fallbacks = 0; // GPU attempts that fell back to CPU
+    };
+    BackendStats backendStats() const;
+
+private:
+    void initializeCore();
+
+    // Advanced image processing algorithms
+    cv::Mat processHDR(const cv::Mat& input);
+    cv::Mat applyToneMapping(const cv::Mat& hdrImage, const std::string& algorithm = "reinhard",
+                             Quality quality = Quality::kBalanced);
+
+    // Preview-tier tone mapping for 8-bit input: one 256-entry LUT folding
+    // the HDR pass's gamma and the Reinhard curve into a single pass, so the
+    // float HDR round trip is skipped entirely
+    cv::Mat applyToneCurveLUT(const cv::Mat& input);
+
+    // Tiled parallel variants: the frame is split into row bands executed
+    // across the OpenCV thread pool; global statistics (normalization range,
+    // log-average luminance) come from a parallel reduction first so output
+    // matches the single-threaded semantics
+    cv::Mat processHDRTiled(const cv::Mat& input);
+    cv::Mat applyToneMappingTiled(const cv::Mat& hdrImage);
+
+    // OpenCL variants of the heavy operations, running on cv::UMat through
+    // the transparent API; only called when the GPU backend is active
+    bool gpuActive() const { return gpu_enabled_; }
+    cv::Mat processHDRGpu(const cv::Mat& input);
+    cv::Mat applyCannyGpu(const cv::Mat& input, bool l2gradient = false);
+    cv::Mat applyExposureFusion(const std::vector<cv::Mat>& images);
+    cv::Mat applyComputerVision(const cv::Mat& input, const std::string& operation,
+                                Quality quality = Quality::kBalanced);
+
+    // SIMD optimized operations
+    void applySIMDOptimization(cv::Mat& image);
+    void vectorizedColorConversion(uint8_t* data, size_t size);
+    void avxImageProcessing(cv::Mat& image);
+
+    // Processor state
+    bool initialized_ = false;
+    bool gpu_enabled_ = false;
+    std::atomic<uint64_t> gpu_ops_{0};
+    std::atomic<uint64_t> cpu_ops_{0};
+    std::atomic<uint64_t> gpu_fallbacks_{0};
+};
+
+#endif // IMAGE_CORE_H
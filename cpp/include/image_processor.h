@@ -5,49 +5,62 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <opencv2/opencv.hpp>
-#include <immintrin.h>
-#include <memory>
 #include <unordered_map>
+#include "descriptor_index.h"
+#include "image_core.h"
+#include "mat_cache.h"
+#include "stage_timer.h"
 
+// N-API wrapper around the shared ImageCore. This class owns only the JS
+// boundary concerns (argument parsing, buffer wrapping, promises, metrics);
+// all operation semantics live in ImageCore so the addon and the gRPC
+// service stay in lockstep.
 class ImageProcessor : public Napi::ObjectWrap<ImageProcessor> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     ImageProcessor(const Napi::CallbackInfo& info);
 
+    using FrameDescriptor = ImageCore::FrameDescriptor;
+
 private:
+    friend class ProcessImageWorker;
+    friend class ProcessExposuresWorker;
+    friend class ProcessBatchWorker;
+    friend class MakeThumbnailsWorker;
+    friend class ProcessFileWorker;
+
     Napi::Value ProcessImage(const Napi::CallbackInfo& info);
+    Napi::Value ProcessImageAsync(const Napi::CallbackInfo& info);
+    Napi::Value ProcessImages(const Napi::CallbackInfo& info);
+    Napi::Value ProcessImagesAsync(const Napi::CallbackInfo& info);
+    Napi::Value ProcessChain(const Napi::CallbackInfo& info);
+    Napi::Value ProcessChainAsync(const Napi::CallbackInfo& info);
+    Napi::Value ProcessBatch(const Napi::CallbackInfo& info);
+    Napi::Value ProcessBatchAsync(const Napi::CallbackInfo& info);
+    Napi::Value MakeThumbnails(const Napi::CallbackInfo& info);
+    Napi::Value MakeThumbnailsAsync(const Napi::CallbackInfo& info);
+    Napi::Value ProcessFile(const Napi::CallbackInfo& info);
+    Napi::Value ProcessFileAsync(const Napi::CallbackInfo& info);
+    Napi::Value CacheImage(const Napi::CallbackInfo& info);
+    Napi::Value ProcessCached(const Napi::CallbackInfo& info);
+    Napi::Value IndexImage(const Napi::CallbackInfo& info);
+    Napi::Value QueryNearest(const Napi::CallbackInfo& info);
+    Napi::Value SaveIndex(const Napi::CallbackInfo& info);
     Napi::Value GetMetrics(const Napi::CallbackInfo& info);
 
-    // Internal processing methods
-    std::vector<uint8_t> processImageData(const std::vector<uint8_t>& input, const std::string& operation);
-    void initializeProcessor();
+    // Metrics bookkeeping shared by the sync and async paths
+    void recordProcessing(const std::string& operation, double processing_time);
 
-    // Advanced image processing algorithms
-    cv::Mat processHDR(const cv::Mat& input);
-    cv::Mat applyToneMapping(const cv::Mat& hdrImage, const std::string& algorithm = "reinhard");
-    cv::Mat applyExposureFusion(const std::vector<cv::Mat>& images);
-    cv::Mat applyComputerVision(const cv::Mat& input, const std::string& operation);
+    // Folds a finished stage trace into the aggregates and emits it through
+    // the sampled trace sink; safe from worker threads
+    void finishTrace(const StageTrace& trace, const std::string& request_name);
 
-    // SIMD optimized operations
-    void applySIMDOptimization(cv::Mat& image);
-    void vectorizedColorConversion(uint8_t* data, size_t size);
-    void avxImageProcessing(cv::Mat& image);
+    // Parses the optional frame-descriptor argument at the given position
+    static FrameDescriptor parseFrameDescriptor(const Napi::CallbackInfo& info, size_t index);
 
-    // Memory management
-    class CustomAllocator {
-    public:
-        static void* allocate(size_t size);
-        static void deallocate(void* ptr);
-    };
-
-    // Zero-copy operations
-    cv::Mat createZeroCopyMat(const std::vector<uint8_t>& data, int width, int height, int channels);
-    std::vector<uint8_t> extractDataFromMat(const cv::Mat& mat);
-
-    // Utility methods
-    cv::Mat bufferToMat(const std::vector<uint8_t>& buffer, int width, int height, int channels);
-    std::vector<uint8_t> matToBuffer(const cv::Mat& mat);
+    // Decodes the (buffer, ..., descriptor?) frame argument shape shared by
+    // the index methods; throws and returns an empty Mat on invalid input
+    cv::Mat decodeFrameArgument(const Napi::CallbackInfo& info);
 
     // Metrics
     struct Metrics {
@@ -57,19 +70,24 @@ private:
         std::unordered_map<std::string, uint64_t> operation_count;
         std::unordered_map<std::string, double> operation_avg_time;
         bool avx_used = false;
-        uint64_t memory_allocated = 0;
     } metrics_;
 
-    // Processor state
-    bool initialized_ = false;
+    // Shared processing core
+    ImageCore core_;
+
+    // Decoded-image cache keyed by content hash; budget configurable via the
+    // constructor's cacheBytes option
+    MatCache cache_;
 
-    // Advanced processing state
-    bool avx_supported_ = false;
-    std::unordered_map<std::string, cv::Ptr<cv::FeatureDetector>> feature_detectors_;
-    std::unordered_map<std::string, cv::Ptr<cv::DescriptorExtractor>> descriptor_extractors_;
+    // ANN index over ORB descriptors for duplicate detection; persistence
+    // path configurable via the constructor's indexPath option
+    DescriptorIndex index_;
 
-    // Memory pool for custom allocation
-    std::vector<void*> memory_pool_;
+    // Always-on per-stage timing aggregates (decode/process/<op>/marshal)
+    // surfaced hierarchically by getMetrics, plus the sampled chrome://tracing
+    // sink configured via the constructor's tracePath/traceEvery options
+    StageStats stage_stats_;
+    TraceSink trace_sink_;
 };
 
-#endif // IMAGE_PROCESSOR_H
\ No newline at end of file
+#endif // IMAGE_PROCESSOR_H
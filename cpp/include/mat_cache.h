@@ -0,0 +1,127 @@
+#ifndef MAT_CACHE_H
+#define MAT_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <unordered_map>
+#include <utility>
+
+// LRU cache of decoded cv::Mats keyed by a 64-bit content hash of the
+// original upload. Lets callers reference a previously sent image by hash
+// instead of re-transferring and re-decoding the same pixels for every
+// derivative (thumbnail, grayscale preview, edge overlay, ...). Evicts least
+// recently used entries once the configured byte budget is exceeded.
+// Thread-safe: the addon's async workers and the JS thread share it.
+class MatCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bytes = 0;
+        uint64_t entries = 0;
+    };
+
+    // Default byte budget (~7 cached 12 MP BGR frames)
+    static constexpr size_t kDefaultBudget = 256 * 1024 * 1024;
+
+    explicit MatCache(size_t budget_bytes = kDefaultBudget) : budget_bytes_(budget_bytes) {}
+
+    // Fast 64-bit content hash (xxHash-style word mixing with an avalanche
+    // finalizer); collisions across distinct uploads are negligible at our
+    // cache sizes
+    static uint64_t hashBytes(const uint8_t* data, size_t size) {
+        const uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+        uint64_t hash = 0x2545F4914F6CDD1DULL ^ (size * kMul);
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ mix(word)) * kMul;
+        }
+        uint64_t tail = 0;
+        for (size_t shift = 0; i < size; ++i, shift += 8) {
+            tail |= (uint64_t)data[i] << shift;
+        }
+        hash = (hash ^ mix(tail)) * kMul;
+        return mix(hash);
+    }
+
+    void put(uint64_t key, const cv::Mat& mat) {
+        size_t mat_bytes = mat.total() * mat.elemSize();
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            // Refresh an existing entry
+            bytes_ -= entryBytes(it->second->second);
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+
+        entries_.emplace_front(key, mat);
+        index_[key] = entries_.begin();
+        bytes_ += mat_bytes;
+
+        while (bytes_ > budget_bytes_ && entries_.size() > 1) {
+            auto& oldest = entries_.back();
+            bytes_ -= entryBytes(oldest.second);
+            index_.erase(oldest.first);
+            entries_.pop_back();
+        }
+    }
+
+    bool get(uint64_t key, cv::Mat& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return false;
+        }
+        // Move to the front of the LRU list
+        entries_.splice(entries_.begin(), entries_, it->second);
+        out = entries_.front().second;
+        hits_++;
+        return true;
+    }
+
+    void setBudget(size_t budget_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_bytes_ = budget_bytes;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.bytes = bytes_;
+        stats.entries = entries_.size();
+        return stats;
+    }
+
+private:
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    static size_t entryBytes(const cv::Mat& mat) {
+        return mat.total() * mat.elemSize();
+    }
+
+    size_t budget_bytes_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    std::list<std::pair<uint64_t, cv::Mat>> entries_; // front = most recent
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, cv::Mat>>::iterator> index_;
+    mutable std::mutex mutex_;
+};
+
+#endif // MAT_CACHE_H
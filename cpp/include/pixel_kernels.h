@@ -0,0 +1,111 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <opencv2/core/hal/interface.h>
+
+#include <cstdint>
+
+// Compile-time specialized elementwise pixel kernels. Each loop is a
+// template over <sample type, channel count>, so both are constants the
+// compiler can unroll and vectorize against — no per-pixel branching and no
+// per-call re-dispatch inside the loop, which is what shows up on small
+// thumbnail frames where the kernel itself is only microseconds. Exactly
+// four instantiations exist, matching the formats that actually flow through
+// the pipeline: 8UC1, 8UC3, 8UC4 and 32FC3 (HDR intermediates). The only
+// runtime dispatch is kernelsForType() at the entry point, resolved once per
+// call.
+namespace pixel {
+
+namespace detail {
+
+template <typename T>
+struct Sample;
+
+template <>
+struct Sample<uint8_t> {
+    static constexpr uint8_t kMax = 255;
+    // Fixed-point x/3: (x * 21846) >> 16, exact for x in [0, 765]
+    static uint8_t averageThree(uint8_t b, uint8_t g, uint8_t r) {
+        return (uint8_t)(((unsigned)(b + g + r) * 21846u) >> 16);
+    }
+};
+
+template <>
+struct Sample<float> {
+    static constexpr float kMax = 1.0f;
+    static float averageThree(float b, float g, float r) {
+        return (b + g + r) * (1.0f / 3.0f);
+    }
+};
+
+template <typename T, int Channels>
+void invertRow(uint8_t* raw, int pixels) {
+    T* p = reinterpret_cast<T*>(raw);
+    for (int i = 0; i < pixels * Channels; ++i) {
+        p[i] = Sample<T>::kMax - p[i];
+    }
+}
+
+// Splats the channel average back into the color channels; a trailing alpha
+// channel is preserved
+template <typename T, int Channels>
+void grayscaleRow(uint8_t* raw, int pixels) {
+    static_assert(Channels >= 3, "grayscale needs color channels");
+    T* p = reinterpret_cast<T*>(raw);
+    for (int i = 0; i < pixels; ++i, p += Channels) {
+        T gray = Sample<T>::averageThree(p[0], p[1], p[2]);
+        p[0] = p[1] = p[2] = gray;
+    }
+}
+
+template <typename T, int Channels>
+void swapRBRow(uint8_t* raw, int pixels) {
+    static_assert(Channels >= 3, "swapRB needs color channels");
+    T* p = reinterpret_cast<T*>(raw);
+    for (int i = 0; i < pixels; ++i, p += Channels) {
+        T tmp = p[0];
+        p[0] = p[2];
+        p[2] = tmp;
+    }
+}
+
+} // namespace detail
+
+// In-place row kernels for one pixel format; entries are null where the
+// operation does not apply (single-channel grayscale/swap)
+struct KernelSet {
+    void (*invert)(uint8_t* row, int pixels) = nullptr;
+    void (*grayscale)(uint8_t* row, int pixels) = nullptr;
+    void (*swapRB)(uint8_t* row, int pixels) = nullptr;
+};
+
+template <typename T, int Channels>
+KernelSet makeKernelSet() {
+    KernelSet set;
+    set.invert = detail::invertRow<T, Channels>;
+    if constexpr (Channels >= 3) {
+        set.grayscale = detail::grayscaleRow<T, Channels>;
+        set.swapRB = detail::swapRBRow<T, Channels>;
+    }
+    return set;
+}
+
+// The thin runtime dispatch: one switch on the OpenCV type at the entry
+// point; null for types outside the four supported formats
+inline const KernelSet* kernelsForType(int cv_type) {
+    static const KernelSet k8uc1 = makeKernelSet<uint8_t, 1>();
+    static const KernelSet k8uc3 = makeKernelSet<uint8_t, 3>();
+    static const KernelSet k8uc4 = makeKernelSet<uint8_t, 4>();
+    static const KernelSet k32fc3 = makeKernelSet<float, 3>();
+    switch (cv_type) {
+        case CV_8UC1: return &k8uc1;
+        case CV_8UC3: return &k8uc3;
+        case CV_8UC4: return &k8uc4;
+        case CV_32FC3: return &k32fc3;
+        default: return nullptr;
+    }
+}
+
+} // namespace pixel
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,43 @@
+#ifndef SIMD_KERNEL_TABLE_H
+#define SIMD_KERNEL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Internal contract between the SIMD dispatcher (simd_kernels.cc) and the
+// per-tier translation units (simd_kernels_{scalar,avx2,avx512,neon}.cc).
+// Each tier is compiled in its own TU with only that tier's instruction-set
+// flags, so no vector instruction can leak into code that runs before the
+// runtime CPU check. Not part of the public simd:: API.
+namespace simd {
+namespace detail {
+
+// One entry per kernel. A tier leaves an entry null when it has no
+// implementation at that width; the dispatcher then keeps the next-best
+// tier's function for that kernel.
+struct KernelTable {
+    void (*invert)(uint8_t*, size_t) = nullptr;
+    void (*shuffleBGRA)(uint8_t*, size_t) = nullptr;
+    void (*avgRows)(const uint8_t*, const uint8_t*, uint8_t*, size_t) = nullptr;
+};
+
+// Baseline kernels — never null, no runtime check needed. SSE2 on x86-64
+// (part of the ABI baseline), plain scalar loops elsewhere.
+const KernelTable& baselineKernels();
+const char* baselineTierName();
+
+// Scalar tail loops shared by the vector tiers for trailing bytes
+void invertScalarTail(uint8_t* data, size_t size);
+void shuffleScalarTail(uint8_t* data, size_t size);
+void avgRowsScalarTail(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size);
+
+// Vector tiers. Each returns nullptr when the tier was compiled out for
+// this target or the running CPU does not support it.
+const KernelTable* avx2Kernels();
+const KernelTable* avx512Kernels();
+const KernelTable* neonKernels();
+
+} // namespace detail
+} // namespace simd
+
+#endif // SIMD_KERNEL_TABLE_H
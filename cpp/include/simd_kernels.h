@@ -0,0 +1,37 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Shared SIMD kernels for the byte-level operations used by both the N-API
+// addon and the gRPC service. Each kernel variant lives in its own
+// translation unit compiled with only that tier's instruction-set flags
+// (SSE2 baseline / AVX2 / AVX-512 on x86-64, NEON on AArch64); the best
+// tier the running CPU supports is selected once at startup, so callers
+// never need to know which tier ran and no binary requires a newer CPU
+// than it was launched on.
+namespace simd {
+
+// Name of the selected tier: "scalar", "sse2", "avx2", "avx512" or "neon"
+const char* tierName();
+
+// Returns true when the AVX2 (or wider) code paths are selected at runtime
+bool avx2Supported();
+
+// In-place byte inversion (255 - x) over the whole buffer
+void invert(uint8_t* data, size_t size);
+
+// In-place BGRA<->RGBA byte shuffle (swaps bytes 0 and 2 of each 4-byte pixel)
+void shuffleBGRA(uint8_t* data, size_t size);
+
+// 2x downscale of an interleaved 8-bit frame with a rounding 2x2 box filter.
+// src is width x height pixels with src_stride bytes per row; dst receives
+// width/2 x height/2 pixels at dst_stride. Odd trailing rows/columns are
+// dropped, matching area resampling at exactly half scale.
+void halve2x2(const uint8_t* src, size_t src_stride, int width, int height,
+              int channels, uint8_t* dst, size_t dst_stride);
+
+} // namespace simd
+
+#endif // SIMD_KERNELS_H
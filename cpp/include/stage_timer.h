@@ -0,0 +1,121 @@
+#ifndef STAGE_TIMER_H
+#define STAGE_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Hierarchical per-request stage timing. A StageTrace is built on one thread
+// as the request flows through its stages: each Scope appends a path segment
+// ("process/invert") while alive and records a span when it closes. The
+// entry points fold finished traces into StageStats for always-on aggregate
+// reporting, and TraceSink can additionally emit a sampled subset as
+// chrome://tracing JSON for flame-graph inspection. The boundary layers own
+// the trace; ImageCore picks up the active trace through a thread-local so
+// per-operation stages need no signature plumbing.
+class StageTrace {
+public:
+    struct Span {
+        std::string path;
+        double start_ms = 0.0;   // relative to process start
+        double duration_ms = 0.0;
+    };
+
+    // RAII stage scope; a null trace makes every operation a no-op, so
+    // instrumented code pays one branch when tracing is inactive
+    class Scope {
+    public:
+        Scope(StageTrace* trace, const std::string& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StageTrace* trace_;
+        size_t parent_length_ = 0;
+        double start_ms_ = 0.0;
+    };
+
+    Scope scope(const std::string& name) { return Scope(this, name); }
+
+    // Scope on the thread's active trace (no-op when none is active)
+    static Scope scopeCurrent(const std::string& name) { return Scope(current(), name); }
+
+    // Marks this trace active on the current thread for its lifetime
+    class Activate {
+    public:
+        explicit Activate(StageTrace* trace);
+        ~Activate();
+
+        Activate(const Activate&) = delete;
+        Activate& operator=(const Activate&) = delete;
+
+    private:
+        StageTrace* previous_;
+    };
+
+    static StageTrace* current();
+
+    const std::vector<Span>& spans() const { return spans_; }
+
+    // Milliseconds since process start (shared epoch for every trace)
+    static double nowMs();
+
+private:
+    friend class Scope;
+
+    std::string path_;
+    std::vector<Span> spans_;
+};
+
+// Aggregate stage timings keyed by stage path. Cheap enough to stay on for
+// every request: one mutex acquisition per finished trace, cost proportional
+// to the trace's span count.
+class StageStats {
+public:
+    struct Entry {
+        uint64_t count = 0;
+        double total_ms = 0.0;
+
+        double averageMs() const { return count > 0 ? total_ms / count : 0.0; }
+    };
+
+    void record(const StageTrace& trace);
+
+    // Ordered by path, so a parent stage always precedes its children
+    std::map<std::string, Entry> snapshot() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
+
+// Sampled chrome://tracing output: every Nth finished trace is appended to
+// the configured file as "X" (complete) events, loadable in chrome://tracing
+// or Perfetto. Disabled until configure() is called with a non-zero rate.
+class TraceSink {
+public:
+    // Emits one of every sample_every traces to path; sample_every == 0
+    // disables the sink
+    void configure(const std::string& path, uint32_t sample_every);
+
+    // True when this request's trace should be written (counts all requests,
+    // so the sample is unbiased under load)
+    bool shouldSample();
+
+    void write(const StageTrace& trace, const std::string& request_name);
+
+private:
+    std::string path_;
+    uint32_t sample_every_ = 0;
+    std::atomic<uint64_t> counter_{0};
+    std::mutex write_mutex_;
+    bool header_written_ = false;
+};
+
+#endif // STAGE_TIMER_H
@@ -0,0 +1,118 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker and work stealing.
+// Tasks are submitted round-robin; each worker pops its own deque from the
+// back (LIFO, cache-warm) and steals from other workers' fronts (FIFO, the
+// oldest work) when its own deque runs dry, so an uneven batch still keeps
+// every core busy.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t thread_count = std::thread::hardware_concurrency()) {
+        if (thread_count == 0) {
+            thread_count = 1;
+        }
+        queues_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            queues_.emplace_back(new WorkerQueue());
+        }
+        workers_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            stopping_ = true;
+        }
+        idle_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task) {
+        size_t index = next_queue_++ % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // Publish under idle_mutex_ so a worker that saw the wait
+            // predicate false cannot block after this notify and miss it
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            pending_++;
+        }
+        idle_cv_.notify_one();
+    }
+
+    size_t threadCount() const { return workers_.size(); }
+
+private:
+    struct WorkerQueue {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    void workerLoop(size_t index) {
+        while (!stopping_) {
+            Task task;
+            if (tryPop(index, task) || trySteal(index, task)) {
+                pending_--;
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            idle_cv_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+        }
+    }
+
+    bool tryPop(size_t index, Task& task) {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        if (queues_[index]->tasks.empty()) {
+            return false;
+        }
+        task = std::move(queues_[index]->tasks.back());
+        queues_[index]->tasks.pop_back();
+        return true;
+    }
+
+    bool trySteal(size_t index, Task& task) {
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            WorkerQueue& victim = *queues_[(index + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<int> pending_{0};
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+};
+
+#endif // WORK_STEALING_POOL_H
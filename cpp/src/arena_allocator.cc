@@ -0,0 +1,169 @@
+#include "arena_allocator.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Smallest pooled block; anything below this goes straight to malloc since
+// pooling tiny headers is not worth the bookkeeping
+constexpr size_t kMinBlockSize = 4096;
+constexpr size_t kSizeClassCount = 16; // 4 KB .. 128 MB
+
+struct ThreadCache {
+    std::vector<void*> free_lists[kSizeClassCount];
+    size_t cached_bytes = 0;
+
+    ~ThreadCache() {
+        for (size_t cls = 0; cls < kSizeClassCount; ++cls) {
+            for (void* block : free_lists[cls]) {
+                std::free(block);
+            }
+        }
+    }
+};
+
+thread_local ThreadCache thread_cache;
+
+size_t blockSizeForClass(size_t cls) {
+    return kMinBlockSize << cls;
+}
+
+} // namespace
+
+ArenaAllocator& ArenaAllocator::instance() {
+    static ArenaAllocator allocator;
+    return allocator;
+}
+
+size_t ArenaAllocator::sizeClassFor(size_t size) {
+    size_t cls = 0;
+    size_t block = kMinBlockSize;
+    while (block < size && cls < kSizeClassCount - 1) {
+        block <<= 1;
+        ++cls;
+    }
+    return cls;
+}
+
+void* ArenaAllocator::allocate(size_t size) {
+    allocations_++;
+
+    if (size > blockSizeForClass(kSizeClassCount - 1)) {
+        // Larger than the biggest size class — bypass the pool
+        bytes_in_use_ += size;
+        return std::malloc(size);
+    }
+
+    size_t cls = sizeClassFor(size);
+    auto& free_list = thread_cache.free_lists[cls];
+    if (!free_list.empty()) {
+        void* block = free_list.back();
+        free_list.pop_back();
+        thread_cache.cached_bytes -= blockSizeForClass(cls);
+        pool_hits_++;
+        bytes_in_use_ += blockSizeForClass(cls);
+        return block;
+    }
+
+    bytes_in_use_ += blockSizeForClass(cls);
+    return std::malloc(blockSizeForClass(cls));
+}
+
+void ArenaAllocator::deallocate(void* ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+
+    if (size > blockSizeForClass(kSizeClassCount - 1)) {
+        bytes_in_use_ -= size;
+        std::free(ptr);
+        return;
+    }
+
+    size_t cls = sizeClassFor(size);
+    bytes_in_use_ -= blockSizeForClass(cls);
+    thread_cache.free_lists[cls].push_back(ptr);
+    thread_cache.cached_bytes += blockSizeForClass(cls);
+
+    // Trim here as well as between requests: threads that only release
+    // (e.g. the JS main thread finalizing zero-copy result Buffers during
+    // GC) never allocate from the arena, so without this their caches
+    // would grow without bound
+    if (thread_cache.cached_bytes > kDefaultCacheBudget) {
+        trimThreadCache();
+    }
+}
+
+void ArenaAllocator::trimThreadCache(size_t budget_bytes) {
+    if (thread_cache.cached_bytes <= budget_bytes) {
+        return;
+    }
+
+    // Drop the largest cached blocks first — they hold the most memory and
+    // are the cheapest to re-request from the OS relative to their size
+    for (size_t cls = kSizeClassCount; cls-- > 0 && thread_cache.cached_bytes > budget_bytes;) {
+        auto& free_list = thread_cache.free_lists[cls];
+        while (!free_list.empty() && thread_cache.cached_bytes > budget_bytes) {
+            std::free(free_list.back());
+            free_list.pop_back();
+            thread_cache.cached_bytes -= blockSizeForClass(cls);
+        }
+    }
+}
+
+ArenaAllocator::Stats ArenaAllocator::stats() const {
+    Stats stats;
+    stats.allocations = allocations_.load();
+    stats.pool_hits = pool_hits_.load();
+    stats.bytes_in_use = bytes_in_use_.load();
+    return stats;
+}
+
+cv::UMatData* MatArenaAllocator::allocate(int dims, const int* sizes, int type, void* data0,
+                                          size_t* step, cv::AccessFlag /*flags*/,
+                                          cv::UMatUsageFlags /*usage_flags*/) const {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != CV_AUTOSTEP) {
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = data0 ? static_cast<uchar*>(data0)
+                        : static_cast<uchar*>(ArenaAllocator::instance().allocate(total));
+    auto* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool MatArenaAllocator::allocate(cv::UMatData* u, cv::AccessFlag /*flags*/,
+                                 cv::UMatUsageFlags /*usage_flags*/) const {
+    return u != nullptr;
+}
+
+void MatArenaAllocator::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        ArenaAllocator::instance().deallocate(u->origdata, u->size);
+    }
+    delete u;
+}
+
+void MatArenaAllocator::install() {
+    static MatArenaAllocator allocator;
+    static std::once_flag installed;
+    std::call_once(installed, [] { cv::Mat::setDefaultAllocator(&allocator); });
+}
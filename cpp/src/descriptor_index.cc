@@ -0,0 +1,158 @@
+#include "descriptor_index.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+
+// Flat binary layout: magic, descriptor width, row count, then per-row
+// image ids, then the raw descriptor bytes
+constexpr uint32_t kIndexMagic = 0x584E5301; // "SNX" + version 1
+
+} // namespace
+
+void DescriptorIndex::setPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+}
+
+size_t DescriptorIndex::add(uint64_t image_id, const cv::Mat& descriptors) {
+    if (descriptors.empty()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    descriptors_.push_back(descriptors);
+    row_ids_.insert(row_ids_.end(), (size_t)descriptors.rows, image_id);
+    image_ids_.insert(image_id);
+    dirty_ = true;
+    return (size_t)descriptors.rows;
+}
+
+void DescriptorIndex::rebuildLocked() {
+    // LSH over Hamming space: 12 tables with 20-bit keys is the usual
+    // operating point for 256-bit ORB descriptors
+    index_ = std::make_unique<cv::flann::Index>(
+        descriptors_, cv::flann::LshIndexParams(12, 20, 2), cvflann::FLANN_DIST_HAMMING);
+    dirty_ = false;
+}
+
+std::vector<DescriptorIndex::Match> DescriptorIndex::queryNearest(const cv::Mat& descriptors,
+                                                                  size_t max_results) {
+    std::vector<Match> matches;
+    if (descriptors.empty() || max_results == 0) {
+        return matches;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (descriptors_.empty()) {
+        return matches;
+    }
+    if (dirty_ || index_ == nullptr) {
+        rebuildLocked();
+    }
+
+    cv::Mat indices, dists;
+    index_->knnSearch(descriptors, indices, dists, 1, cv::flann::SearchParams());
+
+    // Each query descriptor votes for the image owning its nearest neighbor,
+    // provided the neighbor is within the Hamming radius
+    std::unordered_map<uint64_t, uint32_t> votes;
+    for (int row = 0; row < indices.rows; ++row) {
+        int neighbor = indices.at<int>(row, 0);
+        if (neighbor < 0 || (size_t)neighbor >= row_ids_.size()) {
+            continue; // LSH found nothing in any bucket
+        }
+        if (dists.at<int>(row, 0) > kMaxHammingDistance) {
+            continue;
+        }
+        ++votes[row_ids_[neighbor]];
+    }
+
+    for (const auto& pair : votes) {
+        Match match;
+        match.image_id = pair.first;
+        match.votes = pair.second;
+        match.score = (double)pair.second / (double)descriptors.rows;
+        matches.push_back(match);
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const Match& a, const Match& b) { return a.votes > b.votes; });
+    if (matches.size() > max_results) {
+        matches.resize(max_results);
+    }
+    return matches;
+}
+
+bool DescriptorIndex::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        return false;
+    }
+
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    uint32_t magic = kIndexMagic;
+    uint32_t cols = (uint32_t)descriptors_.cols;
+    uint64_t rows = (uint64_t)descriptors_.rows;
+    out.write((const char*)&magic, sizeof(magic));
+    out.write((const char*)&cols, sizeof(cols));
+    out.write((const char*)&rows, sizeof(rows));
+    out.write((const char*)row_ids_.data(), (std::streamsize)(row_ids_.size() * sizeof(uint64_t)));
+    if (rows > 0) {
+        cv::Mat continuous = descriptors_.isContinuous() ? descriptors_ : descriptors_.clone();
+        out.write((const char*)continuous.data, (std::streamsize)(rows * cols));
+    }
+    return out.good();
+}
+
+bool DescriptorIndex::load() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        return false;
+    }
+
+    std::ifstream in(path_, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    uint32_t magic = 0, cols = 0;
+    uint64_t rows = 0;
+    in.read((char*)&magic, sizeof(magic));
+    in.read((char*)&cols, sizeof(cols));
+    in.read((char*)&rows, sizeof(rows));
+    if (!in.good() || magic != kIndexMagic || cols == 0) {
+        return false;
+    }
+
+    std::vector<uint64_t> row_ids(rows);
+    in.read((char*)row_ids.data(), (std::streamsize)(rows * sizeof(uint64_t)));
+    cv::Mat descriptors((int)rows, (int)cols, CV_8U);
+    in.read((char*)descriptors.data, (std::streamsize)(rows * cols));
+    if (!in.good()) {
+        return false;
+    }
+
+    descriptors_ = descriptors;
+    row_ids_ = std::move(row_ids);
+    image_ids_.clear();
+    image_ids_.insert(row_ids_.begin(), row_ids_.end());
+    index_.reset();
+    dirty_ = true; // rebuilt lazily on first query
+    return true;
+}
+
+size_t DescriptorIndex::imageCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return image_ids_.size();
+}
+
+size_t DescriptorIndex::descriptorCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (size_t)descriptors_.rows;
+}
@@ -0,0 +1,942 @@
+#include "image_core.h"
+#include "arena_allocator.h"
+#include "detector_registry.h"
+#include "pixel_kernels.h"
+#include "simd_kernels.h"
+#include "stage_timer.h"
+
+#include <opencv2/core/ocl.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+ImageCore::ImageCore() {
+    initializeCore();
+}
+
+void ImageCore::initializeCore() {
+    // Route Mat pixel storage through the size-classed arena pool
+    MatArenaAllocator::install();
+
+    // Heavy operations go to OpenCL when a device is present. Detectors are
+    // NOT built here — DetectorRegistry constructs them lazily process-wide
+    // on the first feature operation, so constructing a core (one per worker
+    // in a Node cluster) is near-free and prints nothing.
+    setBackend("auto");
+
+    initialized_ = true;
+
+    // Log the environment once per process, not once per instance
+    static std::once_flag log_once;
+    std::call_once(log_once, [this] {
+        std::cout << "C++ ImageCore initialized, SIMD tier: " << simd::tierName()
+                  << ", backend: " << activeBackend() << std::endl;
+    });
+}
+
+bool ImageCore::setBackend(const std::string& name) {
+    std::string backend = name.empty() ? "auto" : name;
+    bool want_gpu = backend == "auto" || backend == "opencl" || backend == "gpu";
+    if (!want_gpu && backend != "cpu") {
+        std::cout << "Unknown backend '" << backend << "', using cpu" << std::endl;
+    }
+
+    if (want_gpu && cv::ocl::haveOpenCL()) {
+        cv::ocl::setUseOpenCL(true);
+        gpu_enabled_ = cv::ocl::useOpenCL();
+    } else {
+        if (backend == "opencl" || backend == "gpu") {
+            std::cout << "OpenCL backend requested but no device available, using cpu" << std::endl;
+        }
+        cv::ocl::setUseOpenCL(false);
+        gpu_enabled_ = false;
+    }
+    return gpu_enabled_;
+}
+
+ImageCore::BackendStats ImageCore::backendStats() const {
+    BackendStats stats;
+    stats.gpu_ops = gpu_ops_.load(std::memory_order_relaxed);
+    stats.cpu_ops = cpu_ops_.load(std::memory_order_relaxed);
+    stats.gpu_fallbacks = gpu_fallbacks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ImageCore::avxSupported() const {
+    return simd::avx2Supported();
+}
+
+const char* ImageCore::simdTier() {
+    return simd::tierName();
+}
+
+// Frame descriptor handling
+int ImageCore::channelsForFormat(const std::string& format) {
+    if (format == "gray") return 1;
+    if (format == "bgra" || format == "rgba") return 4;
+    // bgr, rgb and the converted nv12 frame are all three-channel
+    return 3;
+}
+
+size_t ImageCore::expectedFrameBytes(const FrameDescriptor& desc) {
+    if (isCompressedFormat(desc.format)) {
+        // Compressed payloads have no fixed geometry-derived size; just
+        // require a non-empty buffer
+        return 1;
+    }
+    if (desc.format == "nv12") {
+        // Full-res luma plane plus half-res interleaved chroma plane
+        size_t luma_stride = desc.stride > 0 ? desc.stride : (size_t)desc.width;
+        return luma_stride * desc.height * 3 / 2;
+    }
+    size_t stride = desc.stride > 0 ? desc.stride : (size_t)desc.width * channelsForFormat(desc.format);
+    return stride * desc.height;
+}
+
+bool ImageCore::isKnownFormat(const std::string& format) {
+    return format == "gray" || format == "bgr" || format == "rgb" ||
+           format == "bgra" || format == "rgba" || format == "nv12" ||
+           isCompressedFormat(format);
+}
+
+bool ImageCore::isCompressedFormat(const std::string& format) {
+    return format == "jpeg" || format == "png" || format == "webp";
+}
+
+cv::Mat ImageCore::decodeFrame(const uint8_t* data, size_t length, const FrameDescriptor& desc) {
+    if (isCompressedFormat(desc.format)) {
+        cv::Mat encoded(1, (int)length, CV_8UC1, (void*)data);
+        // Empty result on decode failure; callers surface the error
+        return cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+    }
+    return wrapFrame(data, desc);
+}
+
+std::vector<uint8_t> ImageCore::encodeImage(const cv::Mat& image, const std::string& format, int quality) {
+    std::string extension;
+    std::vector<int> params;
+    if (format == "jpeg") {
+        extension = ".jpg";
+        params = {cv::IMWRITE_JPEG_QUALITY, quality};
+    } else if (format == "webp") {
+        extension = ".webp";
+        params = {cv::IMWRITE_WEBP_QUALITY, quality};
+    } else {
+        extension = ".png";
+        params = {cv::IMWRITE_PNG_COMPRESSION, 3};
+    }
+
+    // Encoders take 8-bit input; scale down float HDR intermediates first
+    cv::Mat src = image;
+    if (image.depth() == CV_32F) {
+        image.convertTo(src, CV_MAKETYPE(CV_8U, image.channels()), 255.0);
+    }
+
+    std::vector<uint8_t> encoded;
+    cv::imencode(extension, src, encoded, params);
+    return encoded;
+}
+
+cv::Mat ImageCore::wrapFrame(const uint8_t* data, const FrameDescriptor& desc) {
+    if (desc.format == "nv12") {
+        // NV12 cannot be processed in place; convert the semi-planar frame to
+        // packed BGR once and run the operation on the converted Mat
+        size_t luma_stride = desc.stride > 0 ? desc.stride : (size_t)desc.width;
+        cv::Mat yuv(desc.height * 3 / 2, desc.width, CV_8UC1, (void*)data, luma_stride);
+        cv::Mat bgr;
+        cv::cvtColor(yuv, bgr, cv::COLOR_YUV2BGR_NV12);
+        return bgr;
+    }
+
+    int channels = channelsForFormat(desc.format);
+    int type = channels == 1 ? CV_8UC1 : (channels == 4 ? CV_8UC4 : CV_8UC3);
+    size_t stride = desc.stride > 0 ? desc.stride : (size_t)desc.width * channels;
+    cv::Mat view(desc.height, desc.width, type, (void*)data, stride);
+    if (desc.format == "rgb" || desc.format == "rgba") {
+        // Channel-order-sensitive paths (grayscale luma weights, the codecs)
+        // assume BGR(A), so swap into an owned canonical copy like the nv12
+        // conversion above. Processed output is BGR(A) regardless of the
+        // input order.
+        cv::Mat bgr;
+        cv::cvtColor(view, bgr,
+                     desc.format == "rgb" ? cv::COLOR_RGB2BGR : cv::COLOR_RGBA2BGRA);
+        return bgr;
+    }
+    return view;
+}
+
+ImageBuffer ImageCore::processImageData(const std::vector<uint8_t>& input, const std::string& operation) {
+    // Legacy vector-based entry point; callers without a descriptor get the
+    // historical 256x256 BGR contract via FrameDescriptor defaults
+    cv::Mat inputMat = wrapFrame(input.data(), FrameDescriptor{});
+
+    return extractDataFromMat(processMat(inputMat, operation));
+}
+
+namespace {
+
+// Execution traits per operation name. elementwise marks pixel-local
+// operations whose output has the input's exact geometry and type, so the
+// result may be computed in the input's own storage under kInPlace.
+struct OperationTraits {
+    bool elementwise = false;
+};
+
+// Runs a compile-time specialized row kernel over every row of the image
+// (or over the whole plane at once when the storage is continuous)
+void applyRowKernel(cv::Mat& image, void (*kernel)(uint8_t*, int)) {
+    if (image.isContinuous()) {
+        kernel(image.data, (int)image.total());
+        return;
+    }
+    for (int y = 0; y < image.rows; ++y) {
+        kernel(image.ptr(y), image.cols);
+    }
+}
+
+// The HDR, tone-mapping, fusion and edge/feature stages assume 3-channel
+// BGR input, but the descriptor also admits gray and bgra frames; OpenCV's
+// merge/tonemap/cvtColor stages CV_Assert on other channel counts instead
+// of converting, so normalize before handing frames to them
+cv::Mat toBGR(const cv::Mat& input) {
+    if (input.channels() == 3) {
+        return input;
+    }
+    cv::Mat bgr;
+    cv::cvtColor(input, bgr,
+                 input.channels() == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR);
+    return bgr;
+}
+
+// Largest resize/thumbnail edge honored; targets are client-controlled
+// ("resize_500000000" would otherwise request a multi-gigapixel Lanczos
+// upscale, and target_edge * 2 in the halving loop would overflow)
+constexpr int kMaxResizeEdge = 8192;
+
+// Byte inversion is channel-agnostic, so 8-bit frames of any format route
+// through the tiered SIMD kernel instead of the per-format templates
+void applySimdInvert(cv::Mat& image) {
+    if (image.isContinuous()) {
+        simd::invert(image.data, image.total() * image.elemSize());
+        return;
+    }
+    size_t row_bytes = (size_t)image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        simd::invert(image.ptr(y), row_bytes);
+    }
+}
+
+const OperationTraits& operationTraits(const std::string& operation) {
+    static const std::unordered_map<std::string, OperationTraits> kTraits = {
+        {"invert", {true}},
+        {"bgr_shuffle", {true}},
+        {"simd_optimize", {true}},
+    };
+    static const OperationTraits kDefault;
+    auto it = kTraits.find(operation);
+    return it != kTraits.end() ? it->second : kDefault;
+}
+
+} // namespace
+
+bool ImageCore::isElementwise(const std::string& operation) {
+    return operationTraits(operation).elementwise;
+}
+
+ImageCore::Quality ImageCore::qualityFromName(const std::string& name) {
+    if (name.empty() || name == "balanced") {
+        return Quality::kBalanced;
+    }
+    if (name == "fast") {
+        return Quality::kFast;
+    }
+    if (name == "best") {
+        return Quality::kBest;
+    }
+    std::cout << "Unknown quality tier: " << name << ", using balanced" << std::endl;
+    return Quality::kBalanced;
+}
+
+cv::Mat ImageCore::processMat(const cv::Mat& inputMat, const std::string& operation, ExecMode mode,
+                              Quality quality) {
+    // Return blocks freed since the last request to the OS past the budget,
+    // so the pool caps RSS growth instead of compounding it
+    ArenaAllocator::instance().trimThreadCache();
+
+    // Per-operation stage span when the request carries an active trace;
+    // a single null check otherwise
+    StageTrace::Scope stage = StageTrace::scopeCurrent(operation);
+
+    // Compile-time specialized kernels for this frame's format; null outside
+    // the four real formats (8UC1/8UC3/8UC4/32FC3)
+    const pixel::KernelSet* kernels = pixel::kernelsForType(inputMat.type());
+
+    if (mode == ExecMode::kInPlace && operationTraits(operation).elementwise &&
+        kernels != nullptr) {
+        // The caller owns the input's storage: write the result into it
+        // instead of allocating a second frame. Mat headers are shallow, so
+        // the const ref does not protect the pixels — kInPlace is the
+        // explicit contract that mutating them is intended.
+        cv::Mat target = inputMat;
+        if (operation == "invert") {
+            if (target.depth() == CV_8U) {
+                applySimdInvert(target);
+            } else {
+                applyRowKernel(target, kernels->invert);
+            }
+        } else if (operation == "bgr_shuffle") {
+            if (target.type() == CV_8UC4 && target.isContinuous()) {
+                // The tiered SIMD shuffle beats the scalar template on the
+                // 4-byte-pixel layout
+                simd::shuffleBGRA(target.data, target.total() * target.elemSize());
+            } else if (kernels->swapRB != nullptr) {
+                applyRowKernel(target, kernels->swapRB);
+            }
+            // single-channel: nothing to swap
+        } else if (operation == "simd_optimize") {
+            applySIMDOptimization(target);
+        }
+        return target;
+    }
+
+    cv::Mat resultMat;
+
+    if (operation == "invert") {
+        if (inputMat.depth() == CV_32F && kernels != nullptr) {
+            // bitwise_not on float storage just flips mantissa bits; the
+            // 32FC3 template kernel computes the intended 1.0 - x
+            resultMat = inputMat.clone();
+            applyRowKernel(resultMat, kernels->invert);
+        } else if (inputMat.depth() == CV_8U) {
+            resultMat = inputMat.clone();
+            applySimdInvert(resultMat);
+        } else {
+            cv::bitwise_not(inputMat, resultMat);
+        }
+    } else if (operation == "grayscale") {
+        if (inputMat.channels() == 4) {
+            cv::cvtColor(inputMat, resultMat, cv::COLOR_BGRA2GRAY);
+        } else if (inputMat.channels() == 3) {
+            cv::cvtColor(inputMat, resultMat, cv::COLOR_BGR2GRAY);
+        } else {
+            resultMat = inputMat.clone();
+        }
+    } else if (operation == "bgr_shuffle") {
+        if (inputMat.channels() == 4) {
+            resultMat = inputMat.clone();
+            simd::shuffleBGRA(resultMat.data, resultMat.total() * resultMat.elemSize());
+        } else if (inputMat.channels() == 3) {
+            cv::cvtColor(inputMat, resultMat, cv::COLOR_BGR2RGB);
+        } else {
+            resultMat = inputMat.clone();
+        }
+    } else if (operation == "hdr") {
+        // Already-float input is already in HDR space; re-running the 8-bit
+        // conversion would clamp it
+        cv::Mat bgr = toBGR(inputMat);
+        resultMat = bgr.depth() == CV_32F ? bgr : processHDR(bgr);
+    } else if (operation == "hdr_tiled") {
+        cv::Mat bgr = toBGR(inputMat);
+        resultMat = bgr.depth() == CV_32F ? bgr : processHDRTiled(bgr);
+    } else if (operation == "tone_mapping_tiled") {
+        cv::Mat bgr = toBGR(inputMat);
+        cv::Mat hdrImage = bgr.depth() == CV_32F ? bgr : processHDRTiled(bgr);
+        resultMat = applyToneMappingTiled(hdrImage);
+    } else if (operation == "tone_mapping") {
+        cv::Mat bgr = toBGR(inputMat);
+        if (quality == Quality::kFast && bgr.depth() == CV_8U) {
+            // Preview tier maps the 8-bit frame through the combined tone
+            // curve directly, skipping the float HDR round trip
+            resultMat = applyToneCurveLUT(bgr);
+        } else {
+            // A float input is an HDR intermediate (e.g. from a preceding
+            // "hdr" chain stage) — tone-map it directly instead of
+            // recomputing the pass. Best tier picks Drago, which holds up
+            // better on extreme ranges at roughly twice the cost.
+            cv::Mat hdrImage = bgr.depth() == CV_32F ? bgr : processHDR(bgr);
+            resultMat = applyToneMapping(hdrImage, quality == Quality::kBest ? "drago" : "reinhard",
+                                         quality);
+        }
+    } else if (operation == "exposure_fusion") {
+        // For demonstration, create multiple exposures from single image
+        cv::Mat bgr = toBGR(inputMat);
+        std::vector<cv::Mat> exposures = {bgr, bgr * 0.5, bgr * 2.0};
+        resultMat = applyExposureFusion(exposures);
+    } else if (operation == "edge_detection") {
+        resultMat = applyComputerVision(toBGR(inputMat), "canny", quality);
+    } else if (operation == "feature_detection") {
+        resultMat = applyComputerVision(toBGR(inputMat), "orb_features");
+    } else if (operation.rfind("resize_", 0) == 0) {
+        // Target edge encoded in the operation name, e.g. "resize_256"
+        int target_edge = std::atoi(operation.c_str() + 7);
+        if (target_edge <= 0) {
+            std::cout << "Invalid resize target: " << operation << std::endl;
+            resultMat = inputMat;
+        } else {
+            resultMat = resizeImage(inputMat, target_edge);
+        }
+    } else if (operation == "encode_jpeg" || operation == "encode_png" || operation == "encode_webp") {
+        // Terminal codec stage: the result Mat is a 1xN byte row holding the
+        // compressed stream, so chains can end with an encode and callers
+        // receive compressed bytes instead of raw pixels
+        std::vector<uint8_t> encoded = encodeImage(inputMat, operation.substr(7));
+        resultMat = cv::Mat(1, (int)encoded.size(), CV_8UC1);
+        std::memcpy(resultMat.data, encoded.data(), encoded.size());
+    } else if (operation == "simd_optimize") {
+        resultMat = inputMat.clone();
+        applySIMDOptimization(resultMat);
+    } else if (operation == "noop") {
+        resultMat = inputMat;
+    } else {
+        std::cout << "Unknown operation: " << operation << std::endl;
+        resultMat = inputMat;
+    }
+
+    return resultMat;
+}
+
+cv::Mat ImageCore::processChain(const cv::Mat& input, const std::vector<std::string>& operations,
+                                ExecMode mode, Quality quality) {
+    // Intermediates stay native Mats the whole way — no per-stage buffer
+    // materialization, and Mat refcounting frees each one as soon as the next
+    // stage no longer needs it
+    cv::Mat current = input;
+    for (const auto& operation : operations) {
+        // Once a stage has materialized its own storage the chain owns it,
+        // so later elementwise stages run in place regardless of the
+        // caller's mode
+        ExecMode stage_mode = (mode == ExecMode::kInPlace || current.data != input.data)
+                                  ? ExecMode::kInPlace
+                                  : ExecMode::kCopy;
+        current = processMat(current, operation, stage_mode, quality);
+    }
+    return current;
+}
+
+cv::Mat ImageCore::processExposures(const std::vector<cv::Mat>& exposures,
+                                    const std::vector<std::string>& operations,
+                                    Quality quality) {
+    if (exposures.empty()) {
+        return cv::Mat();
+    }
+    if (exposures.size() == 1) {
+        // Degenerate bracket: nothing to fuse, run the plain chain
+        return processChain(exposures[0], operations, ExecMode::kCopy, quality);
+    }
+
+    // MTB alignment writes shifted copies into a fresh vector, so zero-copy
+    // input wraps are never mutated
+    std::vector<cv::Mat> aligned;
+    cv::createAlignMTB()->process(exposures, aligned);
+
+    cv::Mat current = applyExposureFusion(aligned);
+
+    size_t next = 0;
+    if (!operations.empty() &&
+        (operations[0] == "exposure_fusion" || operations[0] == "hdr")) {
+        next = 1; // satisfied by the fusion itself
+    }
+    for (size_t i = next; i < operations.size(); ++i) {
+        // The fused frame and everything after it are owned here, so
+        // elementwise stages run in place
+        current = processMat(current, operations[i], ExecMode::kInPlace, quality);
+    }
+    return current;
+}
+
+cv::Mat ImageCore::resizeImage(const cv::Mat& input, int target_edge) {
+    if (target_edge > kMaxResizeEdge) {
+        std::cout << "Resize target " << target_edge << " clamped to " << kMaxResizeEdge
+                  << std::endl;
+        target_edge = kMaxResizeEdge;
+    }
+    int long_edge = std::max(input.cols, input.rows);
+    if (target_edge <= 0 || long_edge == target_edge) {
+        return input;
+    }
+
+    cv::Mat current = input;
+    if (target_edge < long_edge && current.depth() == CV_8U) {
+        // Halve with the SIMD box filter while both dimensions stay at least
+        // twice the target; a power-of-two downscale completes entirely here
+        while (std::max(current.cols, current.rows) >= target_edge * 2 &&
+               current.cols >= 2 && current.rows >= 2) {
+            cv::Mat halved(current.rows / 2, current.cols / 2, current.type());
+            simd::halve2x2(current.data, current.step, current.cols, current.rows,
+                           current.channels(), halved.data, halved.step);
+            current = halved;
+        }
+        long_edge = std::max(current.cols, current.rows);
+        if (long_edge == target_edge) {
+            return current;
+        }
+    }
+
+    // Residual (or non-8-bit) scaling: area resampling down, Lanczos up
+    double scale = (double)target_edge / long_edge;
+    cv::Size target((int)std::lround(current.cols * scale),
+                    (int)std::lround(current.rows * scale));
+    target.width = std::max(target.width, 1);
+    target.height = std::max(target.height, 1);
+
+    cv::Mat resized;
+    cv::resize(current, resized, target, 0, 0,
+               scale < 1.0 ? cv::INTER_AREA : cv::INTER_LANCZOS4);
+    return resized;
+}
+
+std::vector<cv::Mat> ImageCore::makeThumbnails(const cv::Mat& input, const std::vector<int>& edges) {
+    // Generate largest-first so each size downscales from the previous
+    // (still larger) result instead of re-reading the full-resolution source
+    std::vector<size_t> order(edges.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&edges](size_t a, size_t b) { return edges[a] > edges[b]; });
+
+    std::vector<cv::Mat> thumbnails(edges.size());
+    cv::Mat current = input;
+    for (size_t i : order) {
+        cv::Mat next = resizeImage(current, edges[i]);
+        // resizeImage passes through when already at size; clone those so no
+        // two entries (or the input) ever share storage
+        if (next.data == current.data) {
+            next = next.clone();
+        }
+        thumbnails[i] = next;
+        current = next;
+    }
+    return thumbnails;
+}
+
+namespace {
+
+// Read-only mapping of a source file; unmapped on scope exit
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+
+    ~MappedFile() {
+        if (data != nullptr) {
+            munmap((void*)data, length);
+        }
+    }
+
+    bool map(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t*>(base);
+        length = (size_t)st.st_size;
+        return true;
+    }
+};
+
+bool writeFile(const std::string& path, const uint8_t* data, size_t length) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = write(fd, data + written, length - written);
+        if (n < 0) {
+            close(fd);
+            return false;
+        }
+        written += (size_t)n;
+    }
+    return close(fd) == 0;
+}
+
+// Output codec implied by the destination's extension; empty = raw bytes
+std::string formatForExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    if (ext == "jpg" || ext == "jpeg") return "jpeg";
+    if (ext == "png") return "png";
+    if (ext == "webp") return "webp";
+    return "";
+}
+
+} // namespace
+
+std::string ImageCore::sniffImageFormat(const uint8_t* data, size_t length) {
+    if (length >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) {
+        return "jpeg";
+    }
+    if (length >= 8 && std::memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0) {
+        return "png";
+    }
+    if (length >= 12 && std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data + 8, "WEBP", 4) == 0) {
+        return "webp";
+    }
+    return "";
+}
+
+bool ImageCore::processFile(const std::string& in_path, const std::vector<std::string>& operations,
+                            const std::string& out_path, std::string* error,
+                            const FrameDescriptor* raw_desc) {
+    MappedFile source;
+    if (!source.map(in_path)) {
+        *error = "cannot map " + in_path;
+        return false;
+    }
+
+    FrameDescriptor desc;
+    if (raw_desc != nullptr) {
+        desc = *raw_desc;
+    } else {
+        desc.format = sniffImageFormat(source.data, source.length);
+        if (desc.format.empty()) {
+            *error = "unrecognized image file (raw frames need a descriptor): " + in_path;
+            return false;
+        }
+    }
+    if (source.length < expectedFrameBytes(desc)) {
+        *error = "file smaller than described frame: " + in_path;
+        return false;
+    }
+
+    // Raw frames wrap the read-only mapping zero-copy, so the chain runs
+    // under kCopy; compressed sources decode into owned storage first
+    cv::Mat input = decodeFrame(source.data, source.length, desc);
+    if (input.empty()) {
+        *error = "failed to decode " + in_path;
+        return false;
+    }
+    cv::Mat result = processChain(input, operations);
+
+    // A trailing encode_ stage already produced a compressed stream; only
+    // then does the extension-derived codec apply
+    std::string out_format;
+    if (operations.empty() || operations.back().rfind("encode_", 0) != 0) {
+        out_format = formatForExtension(out_path);
+    }
+
+    bool written;
+    if (!out_format.empty()) {
+        std::vector<uint8_t> encoded = encodeImage(result, out_format);
+        written = writeFile(out_path, encoded.data(), encoded.size());
+    } else {
+        // Raw output writes straight from the (arena-backed) Mat storage;
+        // only a non-continuous view needs compacting first
+        cv::Mat flat = result.isContinuous() ? result : result.clone();
+        written = writeFile(out_path, flat.data, flat.total() * flat.elemSize());
+    }
+    if (!written) {
+        *error = "cannot write " + out_path;
+        return false;
+    }
+    return true;
+}
+
+ImageBuffer ImageCore::extractDataFromMat(const cv::Mat& mat) {
+    // elemSize() covers float Mats (e.g. hdr output), not just 8-bit
+    return ImageBuffer(mat.data, mat.data + mat.total() * mat.elemSize());
+}
+
+// Advanced image processing algorithms
+cv::Mat ImageCore::processHDR(const cv::Mat& input) {
+    if (gpuActive()) {
+        try {
+            cv::Mat hdr = processHDRGpu(input);
+            gpu_ops_.fetch_add(1, std::memory_order_relaxed);
+            return hdr;
+        } catch (const cv::Exception& e) {
+            gpu_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            std::cout << "OpenCL HDR pass failed, falling back to CPU: " << e.what() << std::endl;
+        }
+    }
+    cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+
+    cv::Mat hdr;
+    input.convertTo(hdr, CV_32FC3, 1.0/255.0);
+
+    // Simple HDR simulation - in practice, this would combine multiple exposures
+    // For demonstration, apply gamma correction and contrast enhancement
+    cv::pow(hdr, 0.8, hdr); // Gamma correction
+    cv::normalize(hdr, hdr, 0, 1, cv::NORM_MINMAX);
+
+    return hdr;
+}
+
+cv::Mat ImageCore::processHDRGpu(const cv::Mat& input) {
+    // Same sequence as the CPU path, but over UMats: with OpenCL enabled the
+    // transparent API dispatches convertTo/pow/normalize to the device and
+    // keeps the intermediates there, so only the final result crosses back
+    cv::UMat src = input.getUMat(cv::ACCESS_READ);
+    cv::UMat hdr;
+    src.convertTo(hdr, CV_32FC3, 1.0/255.0);
+    cv::pow(hdr, 0.8, hdr);
+    cv::normalize(hdr, hdr, 0, 1, cv::NORM_MINMAX);
+    return hdr.getMat(cv::ACCESS_READ).clone();
+}
+
+cv::Mat ImageCore::applyToneMapping(const cv::Mat& hdrImage, const std::string& algorithm,
+                                    Quality quality) {
+    // The Tonemap classes are CPU-only in OpenCV; always CPU
+    cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+    cv::Mat ldr;
+
+    if (quality == Quality::kFast) {
+        // Preview tier for float HDR intermediates: the closed-form global
+        // Reinhard curve 2x/(1+x), no per-pixel adaptation pass. Matches the
+        // curve applyToneCurveLUT uses for 8-bit input (sans gamma).
+        cv::divide(hdrImage * 2.0, hdrImage + cv::Scalar::all(1.0), ldr);
+        return ldr;
+    }
+
+    if (algorithm == "reinhard") {
+        // Reinhard tone mapping
+        cv::Ptr<cv::TonemapReinhard> tonemapReinhard = cv::createTonemapReinhard(1.5f, 0.0f, 0.0f, 0.0f);
+        tonemapReinhard->process(hdrImage, ldr);
+    } else if (algorithm == "drago") {
+        // Drago tone mapping
+        cv::Ptr<cv::TonemapDrago> tonemapDrago = cv::createTonemapDrago(1.0f, 0.7f);
+        tonemapDrago->process(hdrImage, ldr);
+    } else if (algorithm == "durand") {
+        // Durand tone mapping (using Mantiuk for similar effect)
+        cv::Ptr<cv::TonemapMantiuk> tonemapMantiuk = cv::createTonemapMantiuk(2.2f, 0.85f, 1.2f);
+        tonemapMantiuk->process(hdrImage, ldr);
+    } else {
+        // Default to simple linear mapping
+        hdrImage.convertTo(ldr, CV_8UC3, 255.0);
+    }
+
+    return ldr;
+}
+
+cv::Mat ImageCore::applyToneCurveLUT(const cv::Mat& input) {
+    cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+
+    // 256-entry curve folding the HDR pass's gamma (0.8) and the Reinhard
+    // operator 2x/(1+x) into one 8-bit mapping; cv::LUT applies the
+    // single-channel table to every channel
+    static const cv::Mat kCurve = [] {
+        cv::Mat lut(1, 256, CV_8UC1);
+        for (int i = 0; i < 256; ++i) {
+            float v = std::pow(i / 255.0f, 0.8f);
+            lut.at<uint8_t>(i) = cv::saturate_cast<uint8_t>(2.0f * v / (1.0f + v) * 255.0f);
+        }
+        return lut;
+    }();
+
+    cv::Mat mapped;
+    cv::LUT(input, kCurve, mapped);
+    return mapped;
+}
+
+cv::Mat ImageCore::processHDRTiled(const cv::Mat& input) {
+    cv::Mat hdr(input.size(), CV_32FC3);
+
+    // Phase 1: pixel-local convert + gamma over row bands in parallel
+    cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range& range) {
+        cv::Mat src = input.rowRange(range.start, range.end);
+        cv::Mat dst = hdr.rowRange(range.start, range.end);
+        src.convertTo(dst, CV_32FC3, 1.0/255.0);
+        cv::pow(dst, 0.8, dst);
+    });
+
+    // Phase 2: global min/max reduction, then the normalize applied per band
+    double min_val = 0.0, max_val = 1.0;
+    cv::minMaxIdx(hdr.reshape(1), &min_val, &max_val);
+    double scale = max_val > min_val ? 1.0 / (max_val - min_val) : 1.0;
+    double shift = -min_val * scale;
+    cv::parallel_for_(cv::Range(0, hdr.rows), [&](const cv::Range& range) {
+        cv::Mat band = hdr.rowRange(range.start, range.end);
+        band.convertTo(band, CV_32FC3, scale, shift);
+    });
+
+    return hdr;
+}
+
+cv::Mat ImageCore::applyToneMappingTiled(const cv::Mat& hdrImage) {
+    const float kDelta = 1e-6f;
+    const float kKey = 0.18f;
+    const int rows = hdrImage.rows;
+    const int cols = hdrImage.cols;
+
+    // Global Reinhard operator: the log-average luminance is a frame-wide
+    // statistic, so reduce it in parallel before the per-tile apply pass
+    std::mutex sum_mutex;
+    double log_sum = 0.0;
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        double local_sum = 0.0;
+        for (int y = range.start; y < range.end; ++y) {
+            const cv::Vec3f* row = hdrImage.ptr<cv::Vec3f>(y);
+            for (int x = 0; x < cols; ++x) {
+                // BGR channel order
+                float lum = 0.0722f * row[x][0] + 0.7152f * row[x][1] + 0.2126f * row[x][2];
+                local_sum += std::log(kDelta + lum);
+            }
+        }
+        std::lock_guard<std::mutex> lock(sum_mutex);
+        log_sum += local_sum;
+    });
+    float log_avg = (float)std::exp(log_sum / ((double)rows * cols));
+    float exposure = kKey / std::max(log_avg, kDelta);
+
+    // Apply L' = L*e / (1 + L*e) per pixel, preserving color ratios; each
+    // band is independent so this scales linearly with cores
+    cv::Mat ldr(hdrImage.size(), CV_8UC3);
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const cv::Vec3f* src = hdrImage.ptr<cv::Vec3f>(y);
+            cv::Vec3b* dst = ldr.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < cols; ++x) {
+                float lum = 0.0722f * src[x][0] + 0.7152f * src[x][1] + 0.2126f * src[x][2];
+                float scaled = lum * exposure;
+                float gain = lum > kDelta ? (scaled / (1.0f + scaled)) / lum : 0.0f;
+                for (int c = 0; c < 3; ++c) {
+                    dst[x][c] = cv::saturate_cast<uchar>(src[x][c] * gain * 255.0f);
+                }
+            }
+        }
+    });
+
+    return ldr;
+}
+
+cv::Mat ImageCore::applyExposureFusion(const std::vector<cv::Mat>& images) {
+    // MergeMertens has no OpenCL implementation in OpenCV; always CPU
+    cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+    // Mertens requires 3-channel frames; gray/bgra brackets from the
+    // descriptor path are converted here rather than asserting inside OpenCV
+    std::vector<cv::Mat> frames(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        frames[i] = toBGR(images[i]);
+    }
+    cv::Mat fusion;
+    cv::Ptr<cv::MergeMertens> merge_mertens = cv::createMergeMertens();
+    merge_mertens->process(frames, fusion);
+    return fusion;
+}
+
+cv::Mat ImageCore::applyCannyGpu(const cv::Mat& input, bool l2gradient) {
+    // cvtColor and Canny both have OpenCL kernels; the gray and edge
+    // intermediates stay on the device between stages
+    cv::UMat src = input.getUMat(cv::ACCESS_READ);
+    cv::UMat gray, edges, result;
+    cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+    cv::Canny(gray, edges, 50, 150, 3, l2gradient);
+    cv::cvtColor(edges, result, cv::COLOR_GRAY2BGR);
+    return result.getMat(cv::ACCESS_READ).clone();
+}
+
+cv::Mat ImageCore::extractDescriptors(const cv::Mat& input) {
+    cv::Mat gray;
+    if (input.channels() == 4) {
+        cv::cvtColor(input, gray, cv::COLOR_BGRA2GRAY);
+    } else if (input.channels() == 3) {
+        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = input;
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U, 255.0);
+    }
+
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    DetectorRegistry::instance().detector("ORB")->detectAndCompute(gray, cv::noArray(), keypoints, descriptors);
+    return descriptors;
+}
+
+cv::Mat ImageCore::applyComputerVision(const cv::Mat& input, const std::string& operation,
+                                       Quality quality) {
+    cv::Mat result = input.clone();
+
+    if (operation == "canny") {
+        if (quality == Quality::kFast) {
+            // Preview tier: detect on a pyramid-downsampled frame and scale
+            // the edge map back up. pyrDown's 5x5 Gaussian doubles as the
+            // denoise step and gradient cost drops 4x per level; edge
+            // positions are preview-accurate, not pixel-exact.
+            cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+            cv::Mat small;
+            cv::pyrDown(input, small);
+            while (std::max(small.cols, small.rows) > 1024) {
+                cv::Mat half;
+                cv::pyrDown(small, half);
+                small = half;
+            }
+            cv::Mat gray, edges;
+            cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+            cv::Canny(gray, edges, 50, 150);
+            cv::resize(edges, edges, input.size(), 0, 0, cv::INTER_NEAREST);
+            cv::cvtColor(edges, result, cv::COLOR_GRAY2BGR);
+            return result;
+        }
+        // Best tier uses the L2 gradient norm, which is more accurate on
+        // diagonal edges for ~30% extra gradient cost
+        bool l2gradient = quality == Quality::kBest;
+        if (gpuActive()) {
+            try {
+                result = applyCannyGpu(input, l2gradient);
+                gpu_ops_.fetch_add(1, std::memory_order_relaxed);
+                return result;
+            } catch (const cv::Exception& e) {
+                gpu_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+                std::cout << "OpenCL Canny failed, falling back to CPU: " << e.what() << std::endl;
+            }
+        }
+        cpu_ops_.fetch_add(1, std::memory_order_relaxed);
+        cv::Mat gray, edges;
+        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+        cv::Canny(gray, edges, 50, 150, 3, l2gradient);
+        cv::cvtColor(edges, result, cv::COLOR_GRAY2BGR);
+    } else if (operation == "orb_features") {
+        std::vector<cv::KeyPoint> keypoints;
+        cv::Mat descriptors;
+        DetectorRegistry::instance().detector("ORB")->detectAndCompute(input, cv::noArray(), keypoints, descriptors);
+
+        // Draw keypoints on the image
+        cv::drawKeypoints(input, keypoints, result, cv::Scalar(0, 255, 0));
+    }
+
+    return result;
+}
+
+// SIMD optimizations
+void ImageCore::applySIMDOptimization(cv::Mat& image) {
+    avxImageProcessing(image);
+}
+
+void ImageCore::vectorizedColorConversion(uint8_t* data, size_t size) {
+    // The historical inline AVX mask here was the 4-byte channel swap; the
+    // dispatched kernel keeps that behavior and picks the best instruction
+    // tier for the running CPU (including a portable fallback) instead of
+    // silently doing nothing without AVX
+    simd::shuffleBGRA(data, size);
+}
+
+void ImageCore::avxImageProcessing(cv::Mat& image) {
+    if (image.channels() == 3) {
+        vectorizedColorConversion(image.data, image.total() * image.channels());
+    }
+}
@@ -1,14 +1,396 @@
 #include "image_processor.h"
+#include "arena_allocator.h"
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <algorithm>
-#include <opencv2/opencv.hpp>
-#include <immintrin.h>
-#include <cpuid.h>
+
+// Hands a result Mat's pixel storage to JS without copying. The Mat is
+// refcounted, so a heap copy of the header pinned in the Buffer finalizer
+// keeps the pixels alive until the JS Buffer is collected. Mats that do not
+// own their storage (zero-copy views over an input buffer) fall back to a
+// copy so the result never aliases JS-owned memory.
+static Napi::Buffer<uint8_t> matToNapiBuffer(Napi::Env env, const cv::Mat& mat) {
+    size_t byte_size = mat.total() * mat.elemSize();
+    if (mat.u == nullptr || !mat.isContinuous()) {
+        return Napi::Buffer<uint8_t>::Copy(env, mat.data, byte_size);
+    }
+
+    auto* owned = new cv::Mat(mat);
+    return Napi::Buffer<uint8_t>::New(
+        env, owned->data, byte_size,
+        [](Napi::Env, uint8_t*, cv::Mat* hint) { delete hint; },
+        owned);
+}
+
+// Async worker that runs the shared core off the JS thread on the libuv
+// thread pool. Pool size is configurable via UV_THREADPOOL_SIZE (must be set
+// before the first async call); concurrent uploads are processed in parallel
+// without stalling the event loop.
+class ProcessImageWorker : public Napi::AsyncWorker {
+public:
+    ProcessImageWorker(Napi::Env env, ImageProcessor* processor, Napi::Object self,
+                       Napi::Buffer<uint8_t> input, std::vector<std::string> operations,
+                       ImageProcessor::FrameDescriptor frame,
+                       ImageCore::Quality quality = ImageCore::Quality::kBalanced)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          processor_(processor),
+          self_ref_(Napi::Persistent(self)),
+          input_ref_(Napi::Persistent(input.As<Napi::Object>())),
+          input_data_(input.Data()),
+          input_length_(input.Length()),
+          operations_(std::move(operations)),
+          frame_(std::move(frame)),
+          quality_(quality) {}
+
+    void Execute() override {
+        auto start = std::chrono::high_resolution_clock::now();
+        // input_ref_ pins the JS Buffer, so its memory can be wrapped without a copy
+        cv::Mat inputMat;
+        {
+            StageTrace::Scope stage = trace_.scope("decode");
+            inputMat = processor_->core_.decodeFrame(input_data_, input_length_, frame_);
+        }
+        if (inputMat.empty()) {
+            SetError("Failed to decode compressed image");
+            return;
+        }
+        {
+            StageTrace::Activate activate(&trace_);
+            StageTrace::Scope stage = trace_.scope("process");
+            result_ = processor_->core_.processChain(inputMat, operations_,
+                                                     ImageCore::ExecMode::kCopy, quality_);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        processing_time_ = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void OnOK() override {
+        // Metrics are updated on the JS thread so they stay race-free; chains
+        // are recorded under their joined name (e.g. "hdr+tone_mapping")
+        std::string name = operations_.size() == 1 ? operations_[0] : joinOperations(operations_);
+        processor_->recordProcessing(name, processing_time_);
+        Napi::Value resultBuffer;
+        {
+            StageTrace::Scope stage = trace_.scope("marshal");
+            resultBuffer = matToNapiBuffer(Env(), result_);
+        }
+        processor_->finishTrace(trace_, name);
+        deferred_.Resolve(resultBuffer);
+    }
+
+    static std::string joinOperations(const std::vector<std::string>& operations) {
+        std::string joined;
+        for (const auto& operation : operations) {
+            if (!joined.empty()) {
+                joined += "+";
+            }
+            joined += operation;
+        }
+        return joined;
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ImageProcessor* processor_;
+    Napi::ObjectReference self_ref_;  // keeps the processor alive while queued
+    Napi::ObjectReference input_ref_; // keeps the input Buffer's memory alive
+    const uint8_t* input_data_;
+    size_t input_length_;
+    std::vector<std::string> operations_;
+    ImageProcessor::FrameDescriptor frame_;
+    ImageCore::Quality quality_;
+    cv::Mat result_;
+    StageTrace trace_;
+    double processing_time_ = 0.0;
+};
+
+// Async worker for the multi-exposure entry point. Every input Buffer is
+// pinned with a persistent reference so the bracket's memory stays alive
+// while the fusion runs off the JS thread.
+class ProcessExposuresWorker : public Napi::AsyncWorker {
+public:
+    ProcessExposuresWorker(Napi::Env env, ImageProcessor* processor, Napi::Object self,
+                           const std::vector<Napi::Buffer<uint8_t>>& inputs,
+                           std::vector<std::string> operations,
+                           ImageProcessor::FrameDescriptor frame,
+                           ImageCore::Quality quality = ImageCore::Quality::kBalanced)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          processor_(processor),
+          self_ref_(Napi::Persistent(self)),
+          operations_(std::move(operations)),
+          frame_(std::move(frame)),
+          quality_(quality) {
+        for (const auto& input : inputs) {
+            input_refs_.push_back(Napi::Persistent(input.As<Napi::Object>()));
+            input_spans_.emplace_back(input.Data(), input.Length());
+        }
+    }
+
+    void Execute() override {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<cv::Mat> exposures;
+        for (const auto& span : input_spans_) {
+            cv::Mat exposure = processor_->core_.decodeFrame(span.first, span.second, frame_);
+            if (exposure.empty()) {
+                SetError("Failed to decode exposure");
+                return;
+            }
+            exposures.push_back(exposure);
+        }
+        result_ = processor_->core_.processExposures(exposures, operations_, quality_);
+        auto end = std::chrono::high_resolution_clock::now();
+        processing_time_ = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void OnOK() override {
+        processor_->recordProcessing(ProcessImageWorker::joinOperations(operations_), processing_time_);
+        deferred_.Resolve(matToNapiBuffer(Env(), result_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ImageProcessor* processor_;
+    Napi::ObjectReference self_ref_;
+    std::vector<Napi::ObjectReference> input_refs_;
+    std::vector<std::pair<const uint8_t*, size_t>> input_spans_;
+    std::vector<std::string> operations_;
+    ImageProcessor::FrameDescriptor frame_;
+    ImageCore::Quality quality_;
+    cv::Mat result_;
+    double processing_time_ = 0.0;
+};
+
+// Async worker for the batched entry point: one boundary crossing processes
+// N independent frames through the same operation chain. Every input Buffer
+// is pinned while the batch runs off the JS thread.
+class ProcessBatchWorker : public Napi::AsyncWorker {
+public:
+    ProcessBatchWorker(Napi::Env env, ImageProcessor* processor, Napi::Object self,
+                       const std::vector<Napi::Buffer<uint8_t>>& inputs,
+                       std::vector<std::string> operations,
+                       ImageProcessor::FrameDescriptor frame,
+                       ImageCore::Quality quality)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          processor_(processor),
+          self_ref_(Napi::Persistent(self)),
+          operations_(std::move(operations)),
+          frame_(std::move(frame)),
+          quality_(quality) {
+        for (const auto& input : inputs) {
+            input_refs_.push_back(Napi::Persistent(input.As<Napi::Object>()));
+            input_spans_.emplace_back(input.Data(), input.Length());
+        }
+    }
+
+    void Execute() override {
+        auto start = std::chrono::high_resolution_clock::now();
+        results_.reserve(input_spans_.size());
+        for (const auto& span : input_spans_) {
+            cv::Mat inputMat = processor_->core_.decodeFrame(span.first, span.second, frame_);
+            if (inputMat.empty()) {
+                SetError("Failed to decode batch frame " + std::to_string(results_.size()));
+                return;
+            }
+            // Raw frames wrap JS-owned memory zero-copy, so the chain must
+            // not write through the input: kCopy
+            results_.push_back(processor_->core_.processChain(inputMat, operations_,
+                                                              ImageCore::ExecMode::kCopy, quality_));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        processing_time_ = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void OnOK() override {
+        processor_->recordProcessing(ProcessImageWorker::joinOperations(operations_), processing_time_);
+        Napi::Array results = Napi::Array::New(Env(), results_.size());
+        for (size_t i = 0; i < results_.size(); ++i) {
+            // Result buffers hand over the Mats' arena-backed storage without
+            // a copy, each with its own independent lifetime
+            results.Set((uint32_t)i, matToNapiBuffer(Env(), results_[i]));
+        }
+        deferred_.Resolve(results);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ImageProcessor* processor_;
+    Napi::ObjectReference self_ref_;
+    std::vector<Napi::ObjectReference> input_refs_;
+    std::vector<std::pair<const uint8_t*, size_t>> input_spans_;
+    std::vector<std::string> operations_;
+    ImageProcessor::FrameDescriptor frame_;
+    ImageCore::Quality quality_;
+    std::vector<cv::Mat> results_;
+    double processing_time_ = 0.0;
+};
+
+// Async worker for the file-to-file path: mmap, process and write happen
+// entirely off the JS thread — no file bytes ever cross the boundary
+class ProcessFileWorker : public Napi::AsyncWorker {
+public:
+    ProcessFileWorker(Napi::Env env, ImageProcessor* processor, Napi::Object self,
+                      std::string in_path, std::vector<std::string> operations,
+                      std::string out_path, bool has_frame,
+                      ImageProcessor::FrameDescriptor frame)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          processor_(processor),
+          self_ref_(Napi::Persistent(self)),
+          in_path_(std::move(in_path)),
+          operations_(std::move(operations)),
+          out_path_(std::move(out_path)),
+          has_frame_(has_frame),
+          frame_(std::move(frame)) {}
+
+    void Execute() override {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::string error;
+        if (!processor_->core_.processFile(in_path_, operations_, out_path_, &error,
+                                           has_frame_ ? &frame_ : nullptr)) {
+            SetError(error);
+            return;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        processing_time_ = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void OnOK() override {
+        processor_->recordProcessing(ProcessImageWorker::joinOperations(operations_), processing_time_);
+        deferred_.Resolve(Napi::String::New(Env(), out_path_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ImageProcessor* processor_;
+    Napi::ObjectReference self_ref_;
+    std::string in_path_;
+    std::vector<std::string> operations_;
+    std::string out_path_;
+    bool has_frame_;
+    ImageProcessor::FrameDescriptor frame_;
+    double processing_time_ = 0.0;
+};
+
+// Standard thumbnail edge lengths used when the caller passes no size list
+static const std::vector<int> kThumbnailEdges = {64, 256, 1024};
+
+// Builds the JS result array for a thumbnail set: one {size, width, height,
+// data} object per requested edge, in request order.
+static Napi::Array thumbnailsToNapiArray(Napi::Env env, const std::vector<int>& edges,
+                                         const std::vector<cv::Mat>& thumbnails) {
+    Napi::Array results = Napi::Array::New(env, thumbnails.size());
+    for (size_t i = 0; i < thumbnails.size(); ++i) {
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("size", Napi::Number::New(env, edges[i]));
+        entry.Set("width", Napi::Number::New(env, thumbnails[i].cols));
+        entry.Set("height", Napi::Number::New(env, thumbnails[i].rows));
+        entry.Set("data", matToNapiBuffer(env, thumbnails[i]));
+        results.Set((uint32_t)i, entry);
+    }
+    return results;
+}
+
+// Async worker for the batched thumbnail entry point: one decode, one pass
+// over the source, the whole standard size set back in a single result.
+class MakeThumbnailsWorker : public Napi::AsyncWorker {
+public:
+    MakeThumbnailsWorker(Napi::Env env, ImageProcessor* processor, Napi::Object self,
+                         Napi::Buffer<uint8_t> input, std::vector<int> edges,
+                         ImageProcessor::FrameDescriptor frame)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          processor_(processor),
+          self_ref_(Napi::Persistent(self)),
+          input_ref_(Napi::Persistent(input.As<Napi::Object>())),
+          input_data_(input.Data()),
+          input_length_(input.Length()),
+          edges_(std::move(edges)),
+          frame_(std::move(frame)) {}
+
+    void Execute() override {
+        auto start = std::chrono::high_resolution_clock::now();
+        cv::Mat inputMat = processor_->core_.decodeFrame(input_data_, input_length_, frame_);
+        if (inputMat.empty()) {
+            SetError("Failed to decode compressed image");
+            return;
+        }
+        thumbnails_ = processor_->core_.makeThumbnails(inputMat, edges_);
+        auto end = std::chrono::high_resolution_clock::now();
+        processing_time_ = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void OnOK() override {
+        processor_->recordProcessing("make_thumbnails", processing_time_);
+        deferred_.Resolve(thumbnailsToNapiArray(Env(), edges_, thumbnails_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ImageProcessor* processor_;
+    Napi::ObjectReference self_ref_;
+    Napi::ObjectReference input_ref_;
+    const uint8_t* input_data_;
+    size_t input_length_;
+    std::vector<int> edges_;
+    ImageProcessor::FrameDescriptor frame_;
+    std::vector<cv::Mat> thumbnails_;
+    double processing_time_ = 0.0;
+};
 
 Napi::Object ImageProcessor::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "ImageProcessor", {
         InstanceMethod("processImage", &ImageProcessor::ProcessImage),
+        InstanceMethod("processImageAsync", &ImageProcessor::ProcessImageAsync),
+        InstanceMethod("processImages", &ImageProcessor::ProcessImages),
+        InstanceMethod("processImagesAsync", &ImageProcessor::ProcessImagesAsync),
+        InstanceMethod("processChain", &ImageProcessor::ProcessChain),
+        InstanceMethod("processChainAsync", &ImageProcessor::ProcessChainAsync),
+        InstanceMethod("processBatch", &ImageProcessor::ProcessBatch),
+        InstanceMethod("processBatchAsync", &ImageProcessor::ProcessBatchAsync),
+        InstanceMethod("makeThumbnails", &ImageProcessor::MakeThumbnails),
+        InstanceMethod("makeThumbnailsAsync", &ImageProcessor::MakeThumbnailsAsync),
+        InstanceMethod("processFile", &ImageProcessor::ProcessFile),
+        InstanceMethod("processFileAsync", &ImageProcessor::ProcessFileAsync),
+        InstanceMethod("cacheImage", &ImageProcessor::CacheImage),
+        InstanceMethod("processCached", &ImageProcessor::ProcessCached),
+        InstanceMethod("indexImage", &ImageProcessor::IndexImage),
+        InstanceMethod("queryNearest", &ImageProcessor::QueryNearest),
+        InstanceMethod("saveIndex", &ImageProcessor::SaveIndex),
         InstanceMethod("getMetrics", &ImageProcessor::GetMetrics)
     });
 
@@ -18,26 +400,119 @@ Napi::Object ImageProcessor::Init(Napi::Env env, Napi::Object exports) {
 
 ImageProcessor::ImageProcessor(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<ImageProcessor>(info) {
-    initializeProcessor();
+    // Optional constructor options: { cacheBytes, backend, indexPath }
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("cacheBytes")) {
+            cache_.setBudget((size_t)options.Get("cacheBytes").As<Napi::Number>().Int64Value());
+        }
+        if (options.Has("backend")) {
+            // "cpu" | "opencl" | "auto" — routes the heavy operations, with
+            // automatic CPU fallback when no OpenCL device is present
+            core_.setBackend(options.Get("backend").As<Napi::String>().Utf8Value());
+        }
+        if (options.Has("indexPath")) {
+            // Descriptor index persistence: loaded here, saved via saveIndex()
+            index_.setPath(options.Get("indexPath").As<Napi::String>().Utf8Value());
+            index_.load();
+        }
+        if (options.Has("tracePath")) {
+            // Sampled chrome://tracing output: one of every traceEvery
+            // requests (default 100) is appended to tracePath
+            uint32_t every = 100;
+            if (options.Has("traceEvery")) {
+                every = options.Get("traceEvery").As<Napi::Number>().Uint32Value();
+            }
+            trace_sink_.configure(options.Get("tracePath").As<Napi::String>().Utf8Value(), every);
+        }
+    }
+}
+
+// Reads the optional "quality" tier (fast | balanced | best) from the same
+// options object that carries the frame descriptor; absent means balanced
+static ImageCore::Quality parseQuality(const Napi::CallbackInfo& info, size_t index) {
+    if (info.Length() <= index || !info[index].IsObject()) {
+        return ImageCore::Quality::kBalanced;
+    }
+    Napi::Object options = info[index].As<Napi::Object>();
+    if (!options.Has("quality")) {
+        return ImageCore::Quality::kBalanced;
+    }
+    return ImageCore::qualityFromName(options.Get("quality").As<Napi::String>().Utf8Value());
 }
 
-void ImageProcessor::initializeProcessor() {
-    // Check AVX support
-    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
-    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
-    avx_supported_ = (ecx & (1 << 28)) != 0; // AVX bit
+Napi::Value ImageProcessor::ProcessImage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (!info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (!info[1].IsString()) {
+        Napi::TypeError::New(env, "Second argument must be a string (operation)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    // Initialize computer vision detectors
-    feature_detectors_["ORB"] = cv::ORB::create();
-    feature_detectors_["SIFT"] = cv::SIFT::create();
-    descriptor_extractors_["ORB"] = cv::ORB::create();
-    descriptor_extractors_["SIFT"] = cv::SIFT::create();
+    // Optional third argument describes frame geometry, pixel format and the
+    // quality tier; without it the legacy 256x256 BGR contract applies
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+    ImageCore::Quality quality = parseQuality(info, 2);
 
-    initialized_ = true;
-    std::cout << "C++ ImageProcessor initialized with AVX support: " << (avx_supported_ ? "YES" : "NO") << std::endl;
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string operation = info[1].As<Napi::String>().Utf8Value();
+
+    StageTrace trace;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Wrap the input buffer's memory directly — no copy across the boundary
+    // for raw formats; compressed formats decode here
+    cv::Mat inputMat;
+    {
+        StageTrace::Scope stage = trace.scope("decode");
+        inputMat = core_.decodeFrame(inputBuffer.Data(), inputBuffer.Length(), frame);
+    }
+    if (inputMat.empty()) {
+        Napi::Error::New(env, "Failed to decode compressed image").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    cv::Mat result;
+    {
+        // The active trace gives the core's per-operation spans a parent
+        StageTrace::Activate activate(&trace);
+        StageTrace::Scope stage = trace.scope("process");
+        result = core_.processMat(inputMat, operation, ImageCore::ExecMode::kCopy, quality);
+    }
+
+    Napi::Value resultBuffer;
+    {
+        StageTrace::Scope stage = trace.scope("marshal");
+        // Result buffer without copying Mat-owned pixels
+        resultBuffer = matToNapiBuffer(env, result);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing(operation, std::chrono::duration<double, std::milli>(end - start).count());
+    finishTrace(trace, operation);
+
+    return resultBuffer;
 }
 
-Napi::Value ImageProcessor::ProcessImage(const Napi::CallbackInfo& info) {
+Napi::Value ImageProcessor::ProcessImageAsync(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
     if (info.Length() < 2) {
@@ -55,231 +530,768 @@ Napi::Value ImageProcessor::ProcessImage(const Napi::CallbackInfo& info) {
         return env.Null();
     }
 
-    // Extract input buffer
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
     Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
-    std::vector<uint8_t> input(inputBuffer.Data(), inputBuffer.Data() + inputBuffer.Length());
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    // Extract operation
     std::string operation = info[1].As<Napi::String>().Utf8Value();
 
-    // Process the image
+    auto* worker = new ProcessImageWorker(env, this, info.This().As<Napi::Object>(),
+                                          inputBuffer, std::vector<std::string>{std::move(operation)},
+                                          std::move(frame), parseQuality(info, 2));
+    worker->Queue();
+    return worker->Promise();
+}
+
+// Parses a JS array of operation name strings
+static std::vector<std::string> parseOperationList(Napi::Env env, Napi::Value value) {
+    std::vector<std::string> operations;
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, "Second argument must be an array of operation names").ThrowAsJavaScriptException();
+        return operations;
+    }
+    Napi::Array array = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); ++i) {
+        Napi::Value element = array.Get(i);
+        if (!element.IsString()) {
+            Napi::TypeError::New(env, "Operation names must be strings").ThrowAsJavaScriptException();
+            return operations;
+        }
+        operations.push_back(element.As<Napi::String>().Utf8Value());
+    }
+    if (operations.empty()) {
+        Napi::TypeError::New(env, "Operation chain must not be empty").ThrowAsJavaScriptException();
+    }
+    return operations;
+}
+
+// Parses the frame-list argument shape shared by the exposure and batch
+// entry points: an array of frame Buffers, then either a single operation
+// name or an operation chain. Every frame shares the already-parsed
+// descriptor's geometry; noun names the frames in error messages. Returns
+// false after throwing on invalid input.
+static bool parseFrameListArgs(const Napi::CallbackInfo& info, const std::string& noun,
+                               std::vector<Napi::Buffer<uint8_t>>& buffers,
+                               std::vector<std::string>& operations,
+                               const ImageProcessor::FrameDescriptor& frame) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "First argument must be an array of Buffers").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    if (info[1].IsString()) {
+        operations.push_back(info[1].As<Napi::String>().Utf8Value());
+    } else {
+        operations = parseOperationList(env, info[1]);
+        if (env.IsExceptionPending()) {
+            return false;
+        }
+    }
+
+    Napi::Array array = info[0].As<Napi::Array>();
+    if (array.Length() == 0) {
+        Napi::TypeError::New(env, noun + " array must not be empty").ThrowAsJavaScriptException();
+        return false;
+    }
+    for (uint32_t i = 0; i < array.Length(); ++i) {
+        Napi::Value element = array.Get(i);
+        if (!element.IsBuffer()) {
+            Napi::TypeError::New(env, noun + "s must be Buffers").ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Buffer<uint8_t> buffer = element.As<Napi::Buffer<uint8_t>>();
+        if (buffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+            Napi::RangeError::New(env, noun + " buffer too small for described frame").ThrowAsJavaScriptException();
+            return false;
+        }
+        buffers.push_back(buffer);
+    }
+    return true;
+}
+
+Napi::Value ImageProcessor::ProcessImages(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    std::vector<Napi::Buffer<uint8_t>> buffers;
+    std::vector<std::string> operations;
+    if (!parseFrameListArgs(info, "Exposure", buffers, operations, frame)) {
+        return env.Null();
+    }
+
+    // Each exposure wraps its Buffer's memory directly — a 3-shot 24 MP
+    // bracket crosses the boundary without a single pixel copy
+    std::vector<cv::Mat> exposures;
+    for (const auto& buffer : buffers) {
+        cv::Mat exposure = core_.decodeFrame(buffer.Data(), buffer.Length(), frame);
+        if (exposure.empty()) {
+            Napi::Error::New(env, "Failed to decode exposure").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        exposures.push_back(exposure);
+    }
+
     auto start = std::chrono::high_resolution_clock::now();
-    std::vector<uint8_t> result = processImageData(input, operation);
+    cv::Mat result = core_.processExposures(exposures, operations, parseQuality(info, 2));
     auto end = std::chrono::high_resolution_clock::now();
 
-    double processing_time = std::chrono::duration<double, std::milli>(end - start).count();
+    recordProcessing(ProcessImageWorker::joinOperations(operations),
+                     std::chrono::duration<double, std::milli>(end - start).count());
 
-    // Update metrics
-    metrics_.total_processed++;
-    metrics_.average_time = (metrics_.average_time * (metrics_.total_processed - 1) + processing_time) / metrics_.total_processed;
+    return matToNapiBuffer(env, result);
+}
 
-    // Update operation-specific metrics
-    metrics_.operation_count[operation]++;
-    auto& op_count = metrics_.operation_count[operation];
-    auto& op_avg_time = metrics_.operation_avg_time[operation];
-    op_avg_time = (op_avg_time * (op_count - 1) + processing_time) / op_count;
+Napi::Value ImageProcessor::ProcessImagesAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-    // Track AVX usage
-    if (operation == "simd_optimize" && avx_supported_) {
-        metrics_.avx_used = true;
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    std::vector<Napi::Buffer<uint8_t>> buffers;
+    std::vector<std::string> operations;
+    if (!parseFrameListArgs(info, "Exposure", buffers, operations, frame)) {
+        return env.Null();
     }
 
-    // Return result buffer
-    return Napi::Buffer<uint8_t>::Copy(env, result.data(), result.size());
+    auto* worker = new ProcessExposuresWorker(env, this, info.This().As<Napi::Object>(),
+                                              buffers, std::move(operations), std::move(frame),
+                                              parseQuality(info, 2));
+    worker->Queue();
+    return worker->Promise();
 }
 
-Napi::Value ImageProcessor::GetMetrics(const Napi::CallbackInfo& info) {
+Napi::Value ImageProcessor::ProcessChain(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    Napi::Object metrics = Napi::Object::New(env);
-    metrics.Set("totalProcessed", Napi::Number::New(env, metrics_.total_processed));
-    metrics.Set("averageTime", Napi::Number::New(env, metrics_.average_time));
-    metrics.Set("avxSupported", Napi::Boolean::New(env, avx_supported_));
-    metrics.Set("avxUsed", Napi::Boolean::New(env, metrics_.avx_used));
-    metrics.Set("memoryAllocated", Napi::Number::New(env, metrics_.memory_allocated));
+    if (info.Length() < 2 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    // Operation-specific metrics
-    Napi::Object operations = Napi::Object::New(env);
-    for (const auto& op : metrics_.operation_count) {
-        Napi::Object opMetrics = Napi::Object::New(env);
-        opMetrics.Set("count", Napi::Number::New(env, op.second));
-        opMetrics.Set("averageTime", Napi::Number::New(env, metrics_.operation_avg_time[op.first]));
-        operations.Set(op.first, opMetrics);
+    std::vector<std::string> operations = parseOperationList(env, info[1]);
+    if (env.IsExceptionPending()) {
+        return env.Null();
     }
-    metrics.Set("operations", operations);
 
-    return metrics;
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    cv::Mat inputMat = core_.decodeFrame(inputBuffer.Data(), inputBuffer.Length(), frame);
+    if (inputMat.empty()) {
+        Napi::Error::New(env, "Failed to decode compressed image").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    cv::Mat result = core_.processChain(inputMat, operations, ImageCore::ExecMode::kCopy,
+                                        parseQuality(info, 2));
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing(ProcessImageWorker::joinOperations(operations),
+                     std::chrono::duration<double, std::milli>(end - start).count());
+
+    return matToNapiBuffer(env, result);
 }
 
-std::vector<uint8_t> ImageProcessor::processImageData(const std::vector<uint8_t>& input, const std::string& operation) {
-    // Assume input is RGB data with width=height=256 for simplicity
-    // In production, dimensions should be passed as parameters
-    int width = 256, height = 256, channels = 3;
-    cv::Mat inputMat = bufferToMat(input, width, height, channels);
-
-    cv::Mat resultMat;
-
-    if (operation == "invert") {
-        cv::bitwise_not(inputMat, resultMat);
-    } else if (operation == "grayscale") {
-        cv::cvtColor(inputMat, resultMat, cv::COLOR_BGR2GRAY);
-    } else if (operation == "hdr") {
-        resultMat = processHDR(inputMat);
-    } else if (operation == "tone_mapping") {
-        cv::Mat hdrImage = processHDR(inputMat);
-        resultMat = applyToneMapping(hdrImage, "reinhard");
-    } else if (operation == "exposure_fusion") {
-        // For demonstration, create multiple exposures from single image
-        std::vector<cv::Mat> exposures = {inputMat, inputMat * 0.5, inputMat * 2.0};
-        resultMat = applyExposureFusion(exposures);
-    } else if (operation == "edge_detection") {
-        resultMat = applyComputerVision(inputMat, "canny");
-    } else if (operation == "feature_detection") {
-        resultMat = applyComputerVision(inputMat, "orb_features");
-    } else if (operation == "simd_optimize") {
-        resultMat = inputMat.clone();
-        applySIMDOptimization(resultMat);
-    } else if (operation == "noop") {
-        resultMat = inputMat;
-    } else {
-        std::cout << "Unknown operation: " << operation << std::endl;
-        resultMat = inputMat;
+Napi::Value ImageProcessor::ProcessChainAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<std::string> operations = parseOperationList(env, info[1]);
+    if (env.IsExceptionPending()) {
+        return env.Null();
     }
 
-    return matToBuffer(resultMat);
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto* worker = new ProcessImageWorker(env, this, info.This().As<Napi::Object>(),
+                                          inputBuffer, std::move(operations), std::move(frame),
+                                          parseQuality(info, 2));
+    worker->Queue();
+    return worker->Promise();
 }
 
-// Utility methods
-cv::Mat ImageProcessor::bufferToMat(const std::vector<uint8_t>& buffer, int width, int height, int channels) {
-    cv::Mat mat(height, width, channels == 3 ? CV_8UC3 : CV_8UC1);
-    std::memcpy(mat.data, buffer.data(), buffer.size());
-    return mat;
+// Batched variant of processChain: N independent frames cross the boundary
+// in one call and share one round of argument validation, so the per-call
+// N-API overhead (buffer wrap, handle scope) is amortized over the batch —
+// the dominant cost at thumbnail sizes
+Napi::Value ImageProcessor::ProcessBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+    ImageCore::Quality quality = parseQuality(info, 2);
+
+    std::vector<Napi::Buffer<uint8_t>> buffers;
+    std::vector<std::string> operations;
+    if (!parseFrameListArgs(info, "Batch frame", buffers, operations, frame)) {
+        return env.Null();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<cv::Mat> results;
+    results.reserve(buffers.size());
+    for (const auto& buffer : buffers) {
+        cv::Mat inputMat = core_.decodeFrame(buffer.Data(), buffer.Length(), frame);
+        if (inputMat.empty()) {
+            Napi::Error::New(env, "Failed to decode batch frame " + std::to_string(results.size()))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        results.push_back(core_.processChain(inputMat, operations,
+                                             ImageCore::ExecMode::kCopy, quality));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing(ProcessImageWorker::joinOperations(operations),
+                     std::chrono::duration<double, std::milli>(end - start).count());
+
+    Napi::Array out = Napi::Array::New(env, results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        out.Set((uint32_t)i, matToNapiBuffer(env, results[i]));
+    }
+    return out;
+}
+
+Napi::Value ImageProcessor::ProcessBatchAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    std::vector<Napi::Buffer<uint8_t>> buffers;
+    std::vector<std::string> operations;
+    if (!parseFrameListArgs(info, "Batch frame", buffers, operations, frame)) {
+        return env.Null();
+    }
+
+    auto* worker = new ProcessBatchWorker(env, this, info.This().As<Napi::Object>(),
+                                          buffers, std::move(operations), std::move(frame),
+                                          parseQuality(info, 2));
+    worker->Queue();
+    return worker->Promise();
+}
+
+// Parses the optional thumbnail edge list at the given position; undefined
+// or null selects the standard 64/256/1024 set
+static std::vector<int> parseEdgeList(const Napi::CallbackInfo& info, size_t index) {
+    Napi::Env env = info.Env();
+    if (info.Length() <= index || info[index].IsUndefined() || info[index].IsNull()) {
+        return kThumbnailEdges;
+    }
+    if (!info[index].IsArray()) {
+        Napi::TypeError::New(env, "Sizes must be an array of numbers").ThrowAsJavaScriptException();
+        return {};
+    }
+    Napi::Array array = info[index].As<Napi::Array>();
+    std::vector<int> edges;
+    for (uint32_t i = 0; i < array.Length(); ++i) {
+        Napi::Value element = array.Get(i);
+        if (!element.IsNumber()) {
+            Napi::TypeError::New(env, "Thumbnail sizes must be numbers").ThrowAsJavaScriptException();
+            return {};
+        }
+        int edge = element.As<Napi::Number>().Int32Value();
+        if (edge <= 0) {
+            Napi::RangeError::New(env, "Thumbnail sizes must be positive").ThrowAsJavaScriptException();
+            return {};
+        }
+        edges.push_back(edge);
+    }
+    if (edges.empty()) {
+        Napi::TypeError::New(env, "Size list must not be empty").ThrowAsJavaScriptException();
+    }
+    return edges;
 }
 
-std::vector<uint8_t> ImageProcessor::matToBuffer(const cv::Mat& mat) {
-    std::vector<uint8_t> buffer(mat.total() * mat.channels());
-    std::memcpy(buffer.data(), mat.data, buffer.size());
-    return buffer;
+Napi::Value ImageProcessor::MakeThumbnails(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<int> edges = parseEdgeList(info, 1);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    cv::Mat inputMat = core_.decodeFrame(inputBuffer.Data(), inputBuffer.Length(), frame);
+    if (inputMat.empty()) {
+        Napi::Error::New(env, "Failed to decode compressed image").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<cv::Mat> thumbnails = core_.makeThumbnails(inputMat, edges);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing("make_thumbnails", std::chrono::duration<double, std::milli>(end - start).count());
+
+    return thumbnailsToNapiArray(env, edges, thumbnails);
 }
 
-// Advanced image processing algorithms
-cv::Mat ImageProcessor::processHDR(const cv::Mat& input) {
-    cv::Mat hdr;
-    input.convertTo(hdr, CV_32FC3, 1.0/255.0);
+Napi::Value ImageProcessor::MakeThumbnailsAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<int> edges = parseEdgeList(info, 1);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
 
-    // Simple HDR simulation - in practice, this would combine multiple exposures
-    // For demonstration, apply gamma correction and contrast enhancement
-    cv::pow(hdr, 0.8, hdr); // Gamma correction
-    cv::normalize(hdr, hdr, 0, 1, cv::NORM_MINMAX);
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    return hdr;
+    auto* worker = new MakeThumbnailsWorker(env, this, info.This().As<Napi::Object>(),
+                                            inputBuffer, std::move(edges), std::move(frame));
+    worker->Queue();
+    return worker->Promise();
 }
 
-cv::Mat ImageProcessor::applyToneMapping(const cv::Mat& hdrImage, const std::string& algorithm) {
-    cv::Mat ldr;
-
-    if (algorithm == "reinhard") {
-        // Reinhard tone mapping
-        cv::Ptr<cv::TonemapReinhard> tonemapReinhard = cv::createTonemapReinhard(1.5f, 0.0f, 0.0f, 0.0f);
-        tonemapReinhard->process(hdrImage, ldr);
-    } else if (algorithm == "drago") {
-        // Drago tone mapping
-        cv::Ptr<cv::TonemapDrago> tonemapDrago = cv::createTonemapDrago(1.0f, 0.7f);
-        tonemapDrago->process(hdrImage, ldr);
-    } else if (algorithm == "durand") {
-        // Durand tone mapping (using Mantiuk for similar effect)
-        cv::Ptr<cv::TonemapMantiuk> tonemapMantiuk = cv::createTonemapMantiuk(2.2f, 0.85f, 1.2f);
-        tonemapMantiuk->process(hdrImage, ldr);
+// Parses the (inPath, operation|chain, outPath, descriptor?) argument shape
+// shared by the sync and async file variants. has_frame reports whether an
+// explicit descriptor was supplied — compressed sources are recognized by
+// magic bytes without one. Returns false after throwing on invalid input.
+static bool parseFileArgs(const Napi::CallbackInfo& info, std::string& in_path,
+                          std::vector<std::string>& operations, std::string& out_path,
+                          bool& has_frame) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !info[0].IsString() || !info[2].IsString()) {
+        Napi::TypeError::New(env, "Expected (inPath, operation, outPath)").ThrowAsJavaScriptException();
+        return false;
+    }
+    in_path = info[0].As<Napi::String>().Utf8Value();
+    out_path = info[2].As<Napi::String>().Utf8Value();
+    if (info[1].IsString()) {
+        operations.push_back(info[1].As<Napi::String>().Utf8Value());
     } else {
-        // Default to simple linear mapping
-        hdrImage.convertTo(ldr, CV_8UC3, 255.0);
+        operations = parseOperationList(env, info[1]);
+        if (env.IsExceptionPending()) {
+            return false;
+        }
+    }
+    has_frame = info.Length() > 3 && !info[3].IsUndefined() && !info[3].IsNull();
+    return true;
+}
+
+Napi::Value ImageProcessor::ProcessFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string in_path;
+    std::vector<std::string> operations;
+    std::string out_path;
+    bool has_frame = false;
+    if (!parseFileArgs(info, in_path, operations, out_path, has_frame)) {
+        return env.Null();
+    }
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 3);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string error;
+    if (!core_.processFile(in_path, operations, out_path, &error, has_frame ? &frame : nullptr)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
     }
+    auto end = std::chrono::high_resolution_clock::now();
 
-    return ldr;
+    recordProcessing(ProcessImageWorker::joinOperations(operations),
+                     std::chrono::duration<double, std::milli>(end - start).count());
+
+    return Napi::String::New(env, out_path);
 }
 
-cv::Mat ImageProcessor::applyExposureFusion(const std::vector<cv::Mat>& images) {
-    cv::Mat fusion;
-    cv::Ptr<cv::MergeMertens> merge_mertens = cv::createMergeMertens();
-    merge_mertens->process(images, fusion);
-    return fusion;
+Napi::Value ImageProcessor::ProcessFileAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string in_path;
+    std::vector<std::string> operations;
+    std::string out_path;
+    bool has_frame = false;
+    if (!parseFileArgs(info, in_path, operations, out_path, has_frame)) {
+        return env.Null();
+    }
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 3);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    auto* worker = new ProcessFileWorker(env, this, info.This().As<Napi::Object>(),
+                                         std::move(in_path), std::move(operations),
+                                         std::move(out_path), has_frame, std::move(frame));
+    worker->Queue();
+    return worker->Promise();
 }
 
-cv::Mat ImageProcessor::applyComputerVision(const cv::Mat& input, const std::string& operation) {
-    cv::Mat result = input.clone();
+Napi::Value ImageProcessor::CacheImage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    if (operation == "canny") {
-        cv::Mat gray, edges;
-        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-        cv::Canny(gray, edges, 50, 150);
-        cv::cvtColor(edges, result, cv::COLOR_GRAY2BGR);
-    } else if (operation == "orb_features") {
-        std::vector<cv::KeyPoint> keypoints;
-        cv::Mat descriptors;
-        feature_detectors_["ORB"]->detectAndCompute(input, cv::noArray(), keypoints, descriptors);
+    FrameDescriptor frame = parseFrameDescriptor(info, 1);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
 
-        // Draw keypoints on the image
-        cv::drawKeypoints(input, keypoints, result, cv::Scalar(0, 255, 0));
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return env.Null();
     }
 
-    return result;
+    uint64_t hash = MatCache::hashBytes(inputBuffer.Data(), inputBuffer.Length());
+
+    // Store an owned copy of the decoded frame; subsequent processCached
+    // calls reference it by hash without resending the pixels
+    cv::Mat decoded = core_.decodeFrame(inputBuffer.Data(), inputBuffer.Length(), frame);
+    if (decoded.empty()) {
+        Napi::Error::New(env, "Failed to decode compressed image").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    cache_.put(hash, decoded.u != nullptr ? decoded : decoded.clone());
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return Napi::String::New(env, hex);
 }
 
-// SIMD optimizations
-void ImageProcessor::applySIMDOptimization(cv::Mat& image) {
-    if (!avx_supported_) {
-        std::cout << "AVX not supported, skipping SIMD optimization" << std::endl;
-        return;
+Napi::Value ImageProcessor::ProcessCached(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected (hash, operation) strings").ThrowAsJavaScriptException();
+        return env.Null();
     }
 
-    avxImageProcessing(image);
+    std::string hash_hex = info[0].As<Napi::String>().Utf8Value();
+    uint64_t hash = std::strtoull(hash_hex.c_str(), nullptr, 16);
+
+    cv::Mat cached;
+    if (!cache_.get(hash, cached)) {
+        Napi::Error::New(env, "Image not in cache (evicted or never cached): " + hash_hex)
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string operation = info[1].As<Napi::String>().Utf8Value();
+
+    // Cache hit: no boundary transfer, no buffer wrap — straight to the core
+    auto start = std::chrono::high_resolution_clock::now();
+    cv::Mat result = core_.processMat(cached, operation);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing(operation, std::chrono::duration<double, std::milli>(end - start).count());
+
+    // Pass-through results alias the cache entry; copy those so JS can never
+    // mutate cached pixels through the returned Buffer
+    if (result.data == cached.data) {
+        return Napi::Buffer<uint8_t>::Copy(env, result.data, result.total() * result.elemSize());
+    }
+    return matToNapiBuffer(env, result);
 }
 
-void ImageProcessor::vectorizedColorConversion(uint8_t* data, size_t size) {
-    if (!avx_supported_) return;
+void ImageProcessor::recordProcessing(const std::string& operation, double processing_time) {
+    metrics_.total_processed++;
+    metrics_.average_time = (metrics_.average_time * (metrics_.total_processed - 1) + processing_time) / metrics_.total_processed;
 
-    // AVX vectorized processing for color conversion
-    const __m256i shuffle_mask = _mm256_set_epi8(
-        15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2,
-        15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2
-    );
+    // Update operation-specific metrics
+    metrics_.operation_count[operation]++;
+    auto& op_count = metrics_.operation_count[operation];
+    auto& op_avg_time = metrics_.operation_avg_time[operation];
+    op_avg_time = (op_avg_time * (op_count - 1) + processing_time) / op_count;
 
-    size_t i = 0;
-    for (; i + 31 < size; i += 32) {
-        __m256i pixels = _mm256_loadu_si256((__m256i*)&data[i]);
-        __m256i shuffled = _mm256_shuffle_epi8(pixels, shuffle_mask);
-        _mm256_storeu_si256((__m256i*)&data[i], shuffled);
+    // Track AVX usage
+    if (operation == "simd_optimize" && core_.avxSupported()) {
+        metrics_.avx_used = true;
     }
 }
 
-void ImageProcessor::avxImageProcessing(cv::Mat& image) {
-    if (image.channels() == 3) {
-        vectorizedColorConversion(image.data, image.total() * image.channels());
+void ImageProcessor::finishTrace(const StageTrace& trace, const std::string& request_name) {
+    stage_stats_.record(trace);
+    if (trace_sink_.shouldSample()) {
+        trace_sink_.write(trace, request_name);
     }
 }
 
-// Memory management
-void* ImageProcessor::CustomAllocator::allocate(size_t size) {
-    void* ptr = std::malloc(size);
-    if (ptr) {
-        // Track allocation for debugging
+// Shared by indexImage and queryNearest: decodes the frame argument with
+// the usual (buffer, ..., descriptor?) conventions, descriptor at index 2
+cv::Mat ImageProcessor::decodeFrameArgument(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "First argument must be a Buffer").ThrowAsJavaScriptException();
+        return cv::Mat();
+    }
+
+    FrameDescriptor frame = parseFrameDescriptor(info, 2);
+    if (env.IsExceptionPending()) {
+        return cv::Mat();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    if (inputBuffer.Length() < ImageCore::expectedFrameBytes(frame)) {
+        Napi::RangeError::New(env, "Input buffer too small for described frame").ThrowAsJavaScriptException();
+        return cv::Mat();
     }
-    return ptr;
+
+    cv::Mat inputMat = core_.decodeFrame(inputBuffer.Data(), inputBuffer.Length(), frame);
+    if (inputMat.empty()) {
+        Napi::Error::New(env, "Failed to decode compressed image").ThrowAsJavaScriptException();
+    }
+    return inputMat;
 }
 
-void ImageProcessor::CustomAllocator::deallocate(void* ptr) {
-    if (ptr) {
-        std::free(ptr);
+Napi::Value ImageProcessor::IndexImage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Second argument must be a number (image id)").ThrowAsJavaScriptException();
+        return env.Null();
     }
+
+    cv::Mat inputMat = decodeFrameArgument(info);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    uint64_t image_id = (uint64_t)info[1].As<Napi::Number>().Int64Value();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    cv::Mat descriptors = core_.extractDescriptors(inputMat);
+    size_t added = index_.add(image_id, descriptors);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing("index_image", std::chrono::duration<double, std::milli>(end - start).count());
+
+    // Number of descriptors filed for this image
+    return Napi::Number::New(env, (double)added);
 }
 
-// Zero-copy operations
-cv::Mat ImageProcessor::createZeroCopyMat(const std::vector<uint8_t>& data, int width, int height, int channels) {
-    // Create Mat without copying data
-    return cv::Mat(height, width, channels == 3 ? CV_8UC3 : CV_8UC1, (void*)data.data());
+Napi::Value ImageProcessor::QueryNearest(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    cv::Mat inputMat = decodeFrameArgument(info);
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+
+    size_t max_results = 5;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        max_results = (size_t)info[1].As<Napi::Number>().Int64Value();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    cv::Mat descriptors = core_.extractDescriptors(inputMat);
+    std::vector<DescriptorIndex::Match> matches = index_.queryNearest(descriptors, max_results);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    recordProcessing("query_nearest", std::chrono::duration<double, std::milli>(end - start).count());
+
+    Napi::Array results = Napi::Array::New(env, matches.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        Napi::Object match = Napi::Object::New(env);
+        match.Set("imageId", Napi::Number::New(env, (double)matches[i].image_id));
+        match.Set("votes", Napi::Number::New(env, (double)matches[i].votes));
+        match.Set("score", Napi::Number::New(env, matches[i].score));
+        results.Set((uint32_t)i, match);
+    }
+    return results;
+}
+
+Napi::Value ImageProcessor::SaveIndex(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), index_.save());
 }
 
-std::vector<uint8_t> ImageProcessor::extractDataFromMat(const cv::Mat& mat) {
-    // Extract data without copying if possible
-    return std::vector<uint8_t>(mat.data, mat.data + mat.total() * mat.channels());
-}
\ No newline at end of file
+Napi::Value ImageProcessor::GetMetrics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Napi::Object metrics = Napi::Object::New(env);
+    metrics.Set("totalProcessed", Napi::Number::New(env, metrics_.total_processed));
+    metrics.Set("averageTime", Napi::Number::New(env, metrics_.average_time));
+    metrics.Set("avxSupported", Napi::Boolean::New(env, core_.avxSupported()));
+    metrics.Set("avxUsed", Napi::Boolean::New(env, metrics_.avx_used));
+    metrics.Set("simdTier", Napi::String::New(env, ImageCore::simdTier()));
+
+    // Per-backend counters for the heavy operations
+    ImageCore::BackendStats backend_stats = core_.backendStats();
+    Napi::Object backend = Napi::Object::New(env);
+    backend.Set("name", Napi::String::New(env, core_.activeBackend()));
+    backend.Set("gpuOps", Napi::Number::New(env, (double)backend_stats.gpu_ops));
+    backend.Set("cpuOps", Napi::Number::New(env, (double)backend_stats.cpu_ops));
+    backend.Set("gpuFallbacks", Napi::Number::New(env, (double)backend_stats.gpu_fallbacks));
+    metrics.Set("backend", backend);
+
+    // Arena allocator counters
+    ArenaAllocator::Stats arena_stats = ArenaAllocator::instance().stats();
+    metrics.Set("memoryAllocated", Napi::Number::New(env, (double)arena_stats.bytes_in_use));
+    metrics.Set("arenaAllocations", Napi::Number::New(env, (double)arena_stats.allocations));
+    metrics.Set("arenaPoolHits", Napi::Number::New(env, (double)arena_stats.pool_hits));
+
+    // Decoded-image cache counters
+    MatCache::Stats cache_stats = cache_.stats();
+    Napi::Object cache = Napi::Object::New(env);
+    cache.Set("hits", Napi::Number::New(env, (double)cache_stats.hits));
+    cache.Set("misses", Napi::Number::New(env, (double)cache_stats.misses));
+    cache.Set("bytes", Napi::Number::New(env, (double)cache_stats.bytes));
+    cache.Set("entries", Napi::Number::New(env, (double)cache_stats.entries));
+    metrics.Set("cache", cache);
+
+    // Operation-specific metrics
+    Napi::Object operations = Napi::Object::New(env);
+    for (const auto& op : metrics_.operation_count) {
+        Napi::Object opMetrics = Napi::Object::New(env);
+        opMetrics.Set("count", Napi::Number::New(env, op.second));
+        opMetrics.Set("averageTime", Napi::Number::New(env, metrics_.operation_avg_time[op.first]));
+        operations.Set(op.first, opMetrics);
+    }
+    metrics.Set("operations", operations);
+
+    // Hierarchical stage timings: a path like "process/invert" becomes
+    // stages.process.children.invert, so a latency regression can be pinned
+    // to decode, a specific operation stage, or marshaling at a glance
+    Napi::Object stages = Napi::Object::New(env);
+    for (const auto& pair : stage_stats_.snapshot()) {
+        const std::string& path = pair.first;
+        Napi::Object parent = stages;
+        size_t start = 0;
+        while (true) {
+            size_t slash = path.find('/', start);
+            std::string segment = path.substr(
+                start, slash == std::string::npos ? std::string::npos : slash - start);
+            Napi::Object node;
+            if (parent.Has(segment)) {
+                node = parent.Get(segment).As<Napi::Object>();
+            } else {
+                node = Napi::Object::New(env);
+                parent.Set(segment, node);
+            }
+            if (slash == std::string::npos) {
+                node.Set("count", Napi::Number::New(env, (double)pair.second.count));
+                node.Set("totalTime", Napi::Number::New(env, pair.second.total_ms));
+                node.Set("averageTime", Napi::Number::New(env, pair.second.averageMs()));
+                break;
+            }
+            Napi::Object children;
+            if (node.Has("children")) {
+                children = node.Get("children").As<Napi::Object>();
+            } else {
+                children = Napi::Object::New(env);
+                node.Set("children", children);
+            }
+            parent = children;
+            start = slash + 1;
+        }
+    }
+    metrics.Set("stages", stages);
+
+    return metrics;
+}
+
+ImageProcessor::FrameDescriptor ImageProcessor::parseFrameDescriptor(const Napi::CallbackInfo& info, size_t index) {
+    FrameDescriptor desc;
+    if (info.Length() <= index || info[index].IsUndefined() || info[index].IsNull()) {
+        return desc;
+    }
+
+    Napi::Env env = info.Env();
+    if (!info[index].IsObject()) {
+        Napi::TypeError::New(env, "Frame descriptor must be an object").ThrowAsJavaScriptException();
+        return desc;
+    }
+
+    Napi::Object options = info[index].As<Napi::Object>();
+    if (options.Has("width")) {
+        desc.width = options.Get("width").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("height")) {
+        desc.height = options.Get("height").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("stride")) {
+        desc.stride = options.Get("stride").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("format")) {
+        desc.format = options.Get("format").As<Napi::String>().Utf8Value();
+    }
+
+    if (desc.width <= 0 || desc.height <= 0 || desc.stride < 0) {
+        Napi::RangeError::New(env, "Frame dimensions must be positive").ThrowAsJavaScriptException();
+        return desc;
+    }
+    if (!ImageCore::isKnownFormat(desc.format)) {
+        Napi::TypeError::New(env, "Unknown pixel format: " + desc.format).ThrowAsJavaScriptException();
+        return desc;
+    }
+    return desc;
+}
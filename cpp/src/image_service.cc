@@ -1,12 +1,26 @@
 #include <grpcpp/grpcpp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "arena_allocator.h"
+#include "descriptor_index.h"
+#include "image_core.h"
 #include "image_service.grpc.pb.h"
+#include "sharded_metrics.h"
+#include "stage_timer.h"
+#include "work_stealing_pool.h"
 
+using grpc::CallbackServerContext;
 using grpc::Server;
 using grpc::ServerBuilder;
-using grpc::ServerContext;
 using grpc::Status;
 using snapify::ImageService;
 using snapify::ImageRequest;
@@ -15,142 +29,995 @@ using snapify::BatchRequest;
 using snapify::BatchResponse;
 using snapify::MetricsRequest;
 using snapify::MetricsResponse;
+using snapify::OperationStats;
+using snapify::IndexRequest;
+using snapify::IndexResponse;
+using snapify::QueryRequest;
+using snapify::QueryResponse;
+using snapify::DescriptorMatch;
+
+// Admission gate for the processing RPCs, reworked for the callback server:
+// nothing here ever blocks, because the calling thread is one of gRPC's few
+// reactor threads. A reactor thread reserves a queue slot with enqueue()
+// (shed immediately with RESOURCE_EXHAUSTED when queue_depth requests are
+// already waiting) and the pool worker that picks the task up converts it to
+// an in-flight slot with begin(), shedding instead when the task already sat
+// queued past the target delay — the async equivalent of the old bounded
+// wait. Parallelism itself is bounded by the worker pool's fixed size, so
+// begin() only enforces the deadline. GetMetrics stays outside the gate;
+// observability must keep working during overload.
+class AdmissionController {
+public:
+    AdmissionController(size_t max_inflight, size_t queue_depth, double max_queue_delay_ms)
+        : max_inflight_(max_inflight),
+          queue_depth_(queue_depth),
+          max_queue_delay_ms_(max_queue_delay_ms) {}
+
+    // Reactor thread: reserve a queue slot, or shed
+    bool enqueue() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (waiting_ >= queue_depth_) {
+            ++shed_;
+            return false;
+        }
+        ++waiting_;
+        return true;
+    }
+
+    // Pool worker: convert the queue slot to an in-flight one. A task that
+    // waited past the target delay is shed here instead of processed — its
+    // client has most likely timed out or retried by now.
+    bool begin(double queued_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --waiting_;
+        if (queued_ms > max_queue_delay_ms_) {
+            ++shed_;
+            return false;
+        }
+        ++in_flight_;
+        return true;
+    }
+
+    void release(double service_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+        // EWMA of service time; drives the retry-after estimate below
+        avg_service_ms_ = avg_service_ms_ == 0.0 ? service_ms
+                                                 : avg_service_ms_ * 0.9 + service_ms * 0.1;
+    }
+
+    // Streams hold an in-flight slot end to end (their frames are processed
+    // one at a time, but the stream itself is long-lived); non-blocking
+    bool admitStream() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (streams_ >= max_inflight_) {
+            ++shed_;
+            return false;
+        }
+        ++streams_;
+        return true;
+    }
+
+    void releaseStream() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --streams_;
+    }
+
+    // Suggested client backoff: the time to drain the current backlog at the
+    // observed service rate, at least one average service time
+    uint64_t retryAfterMs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double per_slot = avg_service_ms_ > 0.0 ? avg_service_ms_ : max_queue_delay_ms_;
+        double backlog = (double)(waiting_ + 1) / (double)max_inflight_;
+        return (uint64_t)std::max(per_slot, per_slot * backlog);
+    }
+
+    size_t inFlight() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_flight_ + streams_;
+    }
+
+    uint64_t shedCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shed_;
+    }
+
+private:
+    const size_t max_inflight_;
+    const size_t queue_depth_;
+    const double max_queue_delay_ms_;
+    std::mutex mutex_;
+    size_t in_flight_ = 0;
+    size_t streams_ = 0;
+    size_t waiting_ = 0;
+    uint64_t shed_ = 0;
+    double avg_service_ms_ = 0.0;
+};
+
+// POSIX shared-memory region for the local data plane. RunServer creates
+// and unlinks it; same-host clients mmap the same name, write frames into
+// ring slots at offsets of their choosing, and reference them from
+// ImageRequest via shm_name/shm_offset. The server only ever reads, and
+// every reference is bounds-checked before it is wrapped.
+class ShmRegion {
+public:
+    ~ShmRegion() {
+        if (base_ != nullptr) {
+            munmap(base_, bytes_);
+            shm_unlink(name_.c_str());
+        }
+    }
+
+    bool create(const std::string& name, size_t bytes) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, (off_t)bytes) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd); // the mapping keeps the region alive
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return false;
+        }
+        name_ = name;
+        bytes_ = bytes;
+        base_ = static_cast<uint8_t*>(base);
+        return true;
+    }
+
+    const std::string& name() const { return name_; }
+
+    // Returns the frame's base pointer, or nullptr when the reference falls
+    // outside the region
+    const uint8_t* at(uint64_t offset, size_t length) const {
+        if (base_ == nullptr || offset > bytes_ || length > bytes_ - offset) {
+            return nullptr;
+        }
+        return base_ + offset;
+    }
+
+private:
+    std::string name_;
+    size_t bytes_ = 0;
+    uint8_t* base_ = nullptr;
+};
+
+// Callback-API service: RPC events arrive on gRPC's small fixed set of
+// reactor threads, which only ever parse arguments, check admission and hand
+// the work to the fixed-size worker pool — no thread is ever parked per
+// in-flight RPC, so thousands of concurrent requests cost queue entries, not
+// stacks. All processing runs on the pool; reactors are completed with
+// Finish() from whichever pool thread finishes the work.
+class ImageServiceImpl final : public ImageService::CallbackService {
+private:
+    // Buffered-frame bound per StreamProcess stream; past it the reactor
+    // stops issuing reads so HTTP/2 flow control backpressures the client,
+    // and a large streamed batch peaks at O(queue depth) memory
+    static constexpr size_t kStreamQueueDepth = 8;
+
+    // Lock-free per-thread sharded counters and latency histograms; the
+    // aggregation cost is paid in GetMetrics, not on the request hot path
+    ShardedMetrics metrics_;
+
+    // Fixed-size worker pool all processing runs on; sized to the admission
+    // gate's max_inflight so pool capacity and admitted work agree
+    WorkStealingPool pool_;
+
+    // Shared processing core — the same code the N-API addon runs, so every
+    // operation behaves identically across both entry points
+    ImageCore core_;
+
+    // Shared-memory region owned by RunServer; null when the local data
+    // plane is disabled
+    const ShmRegion* shm_ = nullptr;
+
+    // ANN index over ORB descriptors for duplicate detection
+    DescriptorIndex index_;
+
+    // Bounds concurrent processing RPCs and sheds past the target queue delay
+    AdmissionController admission_;
+
+    // Always-on per-stage timing aggregates plus the sampled chrome://tracing
+    // sink (configured via configureTracing)
+    StageStats stage_stats_;
+    TraceSink trace_sink_;
+
+public:
+    // Admission settings; zero max_inflight selects the core count
+    struct AdmissionConfig {
+        size_t max_inflight = 0;
+        size_t queue_depth = 64;
+        double max_queue_delay_ms = 250.0;
+    };
+
+    // Zero max_inflight selects the core count; used for both the worker
+    // pool size and the admission gate so they cannot drift apart
+    static size_t resolveMaxInflight(const AdmissionConfig& admission) {
+        return admission.max_inflight > 0
+                   ? admission.max_inflight
+                   : (size_t)std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ImageServiceImpl(const std::string& backend, const ShmRegion* shm,
+                     const std::string& index_path, const AdmissionConfig& admission)
+        : pool_(resolveMaxInflight(admission)),
+          shm_(shm),
+          admission_(resolveMaxInflight(admission), admission.queue_depth,
+                     admission.max_queue_delay_ms) {
+        core_.setBackend(backend);
+        if (!index_path.empty()) {
+            index_.setPath(index_path);
+            if (index_.load()) {
+                std::cout << "Descriptor index loaded: " << index_.imageCount() << " images, "
+                          << index_.descriptorCount() << " descriptors" << std::endl;
+            }
+        }
+    }
+
+    // Enables the sampled chrome://tracing output: one of every sample_every
+    // requests is appended to path
+    void configureTracing(const std::string& path, uint32_t sample_every) {
+        trace_sink_.configure(path, sample_every);
+    }
+
+    // Persists the descriptor index on clean shutdown
+    void saveIndex() {
+        if (index_.save()) {
+            std::cout << "Descriptor index saved: " << index_.imageCount() << " images" << std::endl;
+        }
+    }
 
-class ImageServiceImpl final : public ImageService::Service {
 private:
-    // Metrics tracking
-    struct ServiceMetrics {
-        uint64_t total_processed = 0;
-        double average_processing_time = 0.0;
-        uint64_t active_connections = 0;
-        std::map<std::string, uint64_t> operation_counts;
-    } metrics_;
-
-    // Mutex for thread safety
-    std::mutex metrics_mutex_;
-
-    // Image processing logic (same as N-API version)
-    std::vector<uint8_t> processImageData(const std::vector<uint8_t>& input, const std::string& operation) {
-        std::vector<uint8_t> output = input;
-
-        if (operation == "invert") {
-            for (size_t i = 0; i < output.size(); ++i) {
-                output[i] = 255 - output[i];
-            }
-        } else if (operation == "grayscale") {
-            for (size_t i = 0; i < output.size(); i += 3) {
-                if (i + 2 < output.size()) {
-                    uint8_t gray = (output[i] + output[i + 1] + output[i + 2]) / 3;
-                    output[i] = output[i + 1] = output[i + 2] = gray;
+    static ImageCore::FrameDescriptor frameFromRequest(const ImageRequest& request) {
+        ImageCore::FrameDescriptor frame;
+        if (request.width() > 0) {
+            frame.width = (int)request.width();
+        }
+        if (request.height() > 0) {
+            frame.height = (int)request.height();
+        }
+        frame.stride = (int)request.stride();
+        if (!request.pixel_format().empty()) {
+            frame.format = request.pixel_format();
+        }
+        return frame;
+    }
+
+    void recordProcessing(const std::string& operation, double processing_time) {
+        metrics_.record(operation, processing_time);
+    }
+
+    // Metric name matching the addon's convention: chains are recorded under
+    // their joined name (e.g. "hdr+tone_mapping") instead of the empty
+    // single-operation field, and a bare multi-exposure request under the
+    // fusion it implies
+    static std::string requestMetricName(const ImageRequest& request) {
+        if (request.operations_size() == 0) {
+            if (request.operation().empty() && request.exposures_size() > 0) {
+                return "exposure_fusion";
+            }
+            return request.operation();
+        }
+        std::string joined;
+        for (const std::string& operation : request.operations()) {
+            if (!joined.empty()) {
+                joined += "+";
+            }
+            joined += operation;
+        }
+        return joined;
+    }
+
+    // Fast-fail path for a shed RPC; the trailing metadata carries the
+    // suggested backoff so well-behaved clients retry when a slot is likely
+    // to be free instead of hammering immediately
+    Status shedStatus(CallbackServerContext* context) {
+        context->AddTrailingMetadata("retry-after-ms", std::to_string(admission_.retryAfterMs()));
+        return Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "server at capacity");
+    }
+
+    static double msSince(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since)
+            .count();
+    }
+
+    // Completes a shed stream immediately; no slot was taken
+    class ShedStreamReactor : public grpc::ServerBidiReactor<ImageRequest, ImageResponse> {
+    public:
+        explicit ShedStreamReactor(Status status) { Finish(status); }
+        void OnDone() override { delete this; }
+    };
+
+    // Bidi reactor replacing the old three-thread pipeline: reads, pool
+    // processing and writes still overlap, but no thread is dedicated to the
+    // stream. Frames are processed strictly in arrival order by at most one
+    // pool task at a time (matching the old single processor thread), and
+    // when either the pending or the outgoing queue reaches
+    // kStreamQueueDepth the reactor stops issuing reads or pauses
+    // processing, so HTTP/2 flow control backpressures a fast client instead
+    // of the whole batch buffering in memory.
+    class StreamReactor : public grpc::ServerBidiReactor<ImageRequest, ImageResponse> {
+    public:
+        explicit StreamReactor(ImageServiceImpl* service) : service_(service) {
+            StartRead(&incoming_);
+        }
+
+        // All StartRead/StartWrite/Finish calls are issued while holding
+        // mutex_: a cancel can no longer slip between a locked decision to
+        // start an operation and the Start* call itself and sneak Finish in
+        // first — the callback API forbids starting operations after Finish.
+        void OnReadDone(bool ok) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                reads_done_ = true;
+                if (idleLocked()) {
+                    finishLocked(Status::OK);
+                }
+            } else if (!cancelled_) {
+                pending_.push_back(std::move(incoming_));
+                if (!processing_) {
+                    processing_ = true;
+                    submitDrain();
+                }
+                // Keep reading only while the pending queue has room
+                read_paused_ = pending_.size() >= kStreamQueueDepth;
+                if (!read_paused_) {
+                    StartRead(&incoming_);
                 }
             }
-        } else if (operation == "noop") {
-            // No operation
-        } else {
-            std::cout << "Unknown operation: " << operation << std::endl;
         }
 
-        return output;
+        void OnWriteDone(bool ok) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                // A failed write means the call is dead; no further stream
+                // operations are legal
+                cancelled_ = true;
+                write_inflight_ = false;
+                finishLocked(Status::CANCELLED);
+                return;
+            }
+            outgoing_.pop_front();
+            write_inflight_ = false;
+            if (!cancelled_ && !outgoing_.empty()) {
+                write_inflight_ = true;
+                StartWrite(&outgoing_.front());
+            }
+            // Draining pauses when the outgoing queue is full; restart it
+            // now that a slot freed
+            if (!cancelled_ && !processing_ && !pending_.empty() &&
+                outgoing_.size() < kStreamQueueDepth) {
+                processing_ = true;
+                submitDrain();
+            }
+            if (idleLocked()) {
+                finishLocked(Status::OK);
+            }
+        }
+
+        void OnCancel() override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_ = true;
+            finishLocked(Status::CANCELLED);
+        }
+
+        void OnDone() override {
+            service_->admission_.releaseStream();
+            unref();
+        }
+
+    private:
+        // A queued drain task holds a reference so gRPC's OnDone (which can
+        // arrive as soon as the stream is cancelled) cannot delete the
+        // reactor out from under a pool thread
+        void submitDrain() {
+            refs_.fetch_add(1);
+            service_->pool_.submit([this] {
+                drain();
+                unref();
+            });
+        }
+
+        void unref() {
+            if (refs_.fetch_sub(1) == 1) {
+                delete this;
+            }
+        }
+
+        // Processes pending frames in order on a pool thread until the
+        // pending queue is empty or the outgoing queue is full
+        void drain() {
+            for (;;) {
+                ImageRequest request;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (cancelled_ || pending_.empty() ||
+                        outgoing_.size() >= kStreamQueueDepth) {
+                        processing_ = false;
+                        if (idleLocked()) {
+                            finishLocked(Status::OK);
+                        }
+                        return;
+                    }
+                    request = std::move(pending_.front());
+                    pending_.pop_front();
+                }
+                ImageResponse response;
+                service_->processRequest(request, &response);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    outgoing_.push_back(std::move(response));
+                    if (!cancelled_ && !write_inflight_) {
+                        write_inflight_ = true;
+                        StartWrite(&outgoing_.front());
+                    }
+                    // Pending shrank; resume reads if they were paused
+                    if (!cancelled_ && read_paused_ && pending_.size() < kStreamQueueDepth) {
+                        read_paused_ = false;
+                        StartRead(&incoming_);
+                    }
+                }
+            }
+        }
+
+        // The stream is complete when the client stopped sending and every
+        // buffered frame has been processed and written
+        bool idleLocked() const {
+            return reads_done_ && !processing_ && pending_.empty() && outgoing_.empty() &&
+                   !write_inflight_;
+        }
+
+        // Requires mutex_; holding it orders Finish against the locked
+        // Start* calls above so neither can follow the other illegally
+        void finishLocked(const Status& status) {
+            if (!finished_) {
+                finished_ = true;
+                Finish(status);
+            }
+        }
+
+        ImageServiceImpl* service_;
+        ImageRequest incoming_;
+        std::mutex mutex_;
+        std::deque<ImageRequest> pending_;
+        std::deque<ImageResponse> outgoing_; // front() is the write in flight
+        bool processing_ = false;
+        bool write_inflight_ = false;
+        bool read_paused_ = false;
+        bool reads_done_ = false;
+        bool cancelled_ = false;
+        bool finished_ = false;
+        std::atomic<int> refs_{1}; // gRPC's OnDone holds the base reference
+    };
+
+    // Resolves and decodes a single frame from a request — shared-memory
+    // reference for same-host callers, inline image_data otherwise. Returns
+    // false with error filled when the reference or the frame is invalid.
+    bool resolveFrame(const ImageRequest& request, cv::Mat* out, std::string* error) {
+        ImageCore::FrameDescriptor frame = frameFromRequest(request);
+        if (!ImageCore::isKnownFormat(frame.format)) {
+            *error = "unknown pixel format: " + frame.format;
+            return false;
+        }
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(request.image_data().data());
+        size_t length = request.image_data().size();
+        if (!request.shm_name().empty()) {
+            if (shm_ == nullptr || request.shm_name() != shm_->name()) {
+                *error = "unknown shm region: " + request.shm_name();
+                return false;
+            }
+            length = request.shm_length() > 0 ? (size_t)request.shm_length()
+                                              : ImageCore::expectedFrameBytes(frame);
+            data = shm_->at(request.shm_offset(), length);
+            if (data == nullptr) {
+                *error = "shm reference out of range";
+                return false;
+            }
+        }
+        if (length < ImageCore::expectedFrameBytes(frame)) {
+            *error = "image_data smaller than described frame";
+            return false;
+        }
+        *out = core_.decodeFrame(data, length, frame);
+        if (out->empty()) {
+            *error = "failed to decode compressed image";
+            return false;
+        }
+        return true;
     }
 
-public:
-    Status ProcessImage(ServerContext* context, const ImageRequest* request, ImageResponse* response) override {
-        auto start = std::chrono::high_resolution_clock::now();
+    // Shared by the unary, batch and streaming paths: runs one request
+    // through the core and fills in the response including its timing.
+    // OpenCV throws cv::Exception on input combinations its stages reject
+    // and on allocation failure, and nothing above the pool's worker loop
+    // catches — an escaped exception would terminate the whole server — so
+    // this is the exception barrier that converts them to error responses.
+    void processRequest(const ImageRequest& request, ImageResponse* response) {
+        try {
+            processRequestUnguarded(request, response);
+        } catch (const std::exception& e) {
+            response->Clear();
+            response->set_status("error");
+            response->set_error_message(e.what());
+        }
+    }
 
-        // Extract image data
-        std::vector<uint8_t> input(request->image_data().begin(), request->image_data().end());
-        std::string operation = request->operation();
+    void processRequestUnguarded(const ImageRequest& request, ImageResponse* response) {
+        const std::string& operation = request.operation();
 
-        // Process the image
-        std::vector<uint8_t> result = processImageData(input, operation);
+        // Stage trace for this request: decode / process (with per-operation
+        // children from the core) / marshal. Aggregated always; sampled into
+        // the chrome://tracing sink when enabled.
+        StageTrace trace;
+        StageTrace::Activate activate(&trace);
 
-        // Set response
-        response->set_processed_data(result.data(), result.size());
-        response->set_status("success");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if (!request.file_path().empty()) {
+            // File-to-file job: mmap in, process, write out — no pixel bytes
+            // in either protobuf direction
+            if (request.output_path().empty()) {
+                response->set_status("error");
+                response->set_error_message("file_path requires output_path");
+                return;
+            }
+            std::vector<std::string> operations(request.operations().begin(), request.operations().end());
+            if (operations.empty() && !operation.empty()) {
+                operations.push_back(operation);
+            }
+            ImageCore::FrameDescriptor frame = frameFromRequest(request);
+            std::string error;
+            bool ok;
+            {
+                StageTrace::Scope stage = trace.scope("process");
+                ok = core_.processFile(request.file_path(), operations, request.output_path(),
+                                       &error, request.pixel_format().empty() ? nullptr : &frame);
+            }
+            if (!ok) {
+                response->set_status("error");
+                response->set_error_message(error);
+                return;
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double processing_time = std::chrono::duration<double, std::milli>(end - start).count();
+            response->set_processing_time(processing_time);
+            response->set_status("success");
+            recordProcessing(operation.empty() ? "process_file" : operation, processing_time);
+            stage_stats_.record(trace);
+            return;
+        }
 
+        cv::Mat result;
+        if (request.exposures_size() > 0) {
+            // Real multi-exposure bracket: every frame shares the request's
+            // geometry; the core aligns and fuses before the operations run
+            ImageCore::FrameDescriptor frame = frameFromRequest(request);
+            if (!ImageCore::isKnownFormat(frame.format)) {
+                response->set_status("error");
+                response->set_error_message("unknown pixel format: " + frame.format);
+                return;
+            }
+            std::vector<cv::Mat> exposures;
+            {
+                StageTrace::Scope stage = trace.scope("decode");
+                for (const std::string& bytes : request.exposures()) {
+                    if (bytes.size() < ImageCore::expectedFrameBytes(frame)) {
+                        response->set_status("error");
+                        response->set_error_message("exposure smaller than described frame");
+                        return;
+                    }
+                    cv::Mat exposure = core_.decodeFrame(reinterpret_cast<const uint8_t*>(bytes.data()),
+                                                         bytes.size(), frame);
+                    if (exposure.empty()) {
+                        response->set_status("error");
+                        response->set_error_message("failed to decode exposure");
+                        return;
+                    }
+                    exposures.push_back(exposure);
+                }
+            }
+            std::vector<std::string> operations(request.operations().begin(), request.operations().end());
+            if (operations.empty()) {
+                operations.push_back(operation.empty() ? "exposure_fusion" : operation);
+            }
+            StageTrace::Scope stage = trace.scope("process");
+            result = core_.processExposures(exposures, operations,
+                                            ImageCore::qualityFromName(request.quality()));
+        } else {
+            cv::Mat input;
+            std::string error;
+            {
+                StageTrace::Scope stage = trace.scope("decode");
+                if (!resolveFrame(request, &input, &error)) {
+                    response->set_status("error");
+                    response->set_error_message(error);
+                    return;
+                }
+            }
+            // Inline image_data belongs to this request, so elementwise
+            // operations may write their result straight into it instead of
+            // allocating a second frame; shm slots belong to the client's
+            // ring and must never be written
+            ImageCore::ExecMode mode = request.shm_name().empty() ? ImageCore::ExecMode::kInPlace
+                                                                  : ImageCore::ExecMode::kCopy;
+            ImageCore::Quality quality = ImageCore::qualityFromName(request.quality());
+            StageTrace::Scope stage = trace.scope("process");
+            if (request.operations_size() > 0) {
+                // Ordered chain runs as one native pipeline over shared intermediates
+                std::vector<std::string> operations(request.operations().begin(), request.operations().end());
+                result = core_.processChain(input, operations, mode, quality);
+            } else {
+                result = core_.processMat(input, operation, mode, quality);
+            }
+        }
         auto end = std::chrono::high_resolution_clock::now();
+
         double processing_time = std::chrono::duration<double, std::milli>(end - start).count();
-        response->set_processing_time(processing_time);
 
-        // Update metrics
         {
-            std::lock_guard<std::mutex> lock(metrics_mutex_);
-            metrics_.total_processed++;
-            metrics_.average_processing_time =
-                (metrics_.average_processing_time * (metrics_.total_processed - 1) + processing_time) / metrics_.total_processed;
-            metrics_.operation_counts[operation]++;
+            StageTrace::Scope stage = trace.scope("marshal");
+            // Pass-through results over a padded-stride input are not
+            // continuous; compact them before serializing
+            cv::Mat out = result.isContinuous() ? result : result.clone();
+            response->set_processed_data(out.data, out.total() * out.elemSize());
+        }
+        response->set_processing_time(processing_time);
+        response->set_status("success");
+
+        recordProcessing(requestMetricName(request), processing_time);
+        stage_stats_.record(trace);
+        if (trace_sink_.shouldSample()) {
+            trace_sink_.write(trace, operation.empty() ? "chain" : operation);
         }
+    }
 
-        return Status::OK;
+public:
+    grpc::ServerUnaryReactor* ProcessImage(CallbackServerContext* context,
+                                           const ImageRequest* request,
+                                           ImageResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        if (!admission_.enqueue()) {
+            reactor->Finish(shedStatus(context));
+            return reactor;
+        }
+        auto queued_at = std::chrono::steady_clock::now();
+        pool_.submit([this, context, request, response, reactor, queued_at] {
+            if (!admission_.begin(msSince(queued_at))) {
+                reactor->Finish(shedStatus(context));
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
+            processRequest(*request, response);
+            admission_.release(msSince(start));
+            reactor->Finish(Status::OK);
+        });
+        return reactor;
     }
 
-    Status BatchProcess(ServerContext* context, const BatchRequest* request, BatchResponse* response) override {
-        auto start = std::chrono::high_resolution_clock::now();
+    grpc::ServerUnaryReactor* BatchProcess(CallbackServerContext* context,
+                                           const BatchRequest* request,
+                                           BatchResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        // One admission slot per batch RPC; the fan-out below bounds itself
+        // through the pool's fixed size
+        if (!admission_.enqueue()) {
+            reactor->Finish(shedStatus(context));
+            return reactor;
+        }
+        auto queued_at = std::chrono::steady_clock::now();
 
-        for (const auto& image_request : request->requests()) {
-            ImageResponse* image_response = response->add_responses();
+        pool_.submit([this, context, request, response, reactor, queued_at] {
+            if (!admission_.begin(msSince(queued_at))) {
+                reactor->Finish(shedStatus(context));
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
 
-            // Process each image
-            std::vector<uint8_t> input(image_request.image_data().begin(), image_request.image_data().end());
-            std::string operation = image_request.operation();
+            // Preallocate one response slot per request so workers write
+            // results in place: ordering is preserved without any merge lock
+            int count = request->requests_size();
+            for (int i = 0; i < count; ++i) {
+                response->add_responses();
+            }
+            if (count == 0) {
+                response->set_total_time(0.0);
+                admission_.release(msSince(start));
+                reactor->Finish(Status::OK);
+                return;
+            }
 
-            auto image_start = std::chrono::high_resolution_clock::now();
-            std::vector<uint8_t> result = processImageData(input, operation);
-            auto image_end = std::chrono::high_resolution_clock::now();
+            // The last item to finish completes the RPC; no thread waits
+            auto remaining = std::make_shared<std::atomic<int>>(count);
+            for (int i = 0; i < count; ++i) {
+                pool_.submit([this, request, response, reactor, start, remaining, i] {
+                    processRequest(request->requests(i), response->mutable_responses(i));
+                    if (remaining->fetch_sub(1) == 1) {
+                        double total_time = msSince(start);
+                        response->set_total_time(total_time);
+                        admission_.release(total_time);
+                        reactor->Finish(Status::OK);
+                    }
+                });
+            }
+        });
+        return reactor;
+    }
 
-            double processing_time = std::chrono::duration<double, std::milli>(image_end - image_start).count();
+    grpc::ServerBidiReactor<ImageRequest, ImageResponse>* StreamProcess(
+        CallbackServerContext* context) override {
+        if (!admission_.admitStream()) {
+            return new ShedStreamReactor(shedStatus(context));
+        }
+        // The reactor deletes itself in OnDone and releases the stream slot
+        return new StreamReactor(this);
+    }
 
-            image_response->set_processed_data(result.data(), result.size());
-            image_response->set_processing_time(processing_time);
-            image_response->set_status("success");
+    grpc::ServerUnaryReactor* IndexImage(CallbackServerContext* context,
+                                         const IndexRequest* request,
+                                         IndexResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        if (!admission_.enqueue()) {
+            reactor->Finish(shedStatus(context));
+            return reactor;
+        }
+        auto queued_at = std::chrono::steady_clock::now();
+        pool_.submit([this, context, request, response, reactor, queued_at] {
+            if (!admission_.begin(msSince(queued_at))) {
+                reactor->Finish(shedStatus(context));
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
 
-            // Update metrics
-            {
-                std::lock_guard<std::mutex> lock(metrics_mutex_);
-                metrics_.total_processed++;
-                metrics_.average_processing_time =
-                    (metrics_.average_processing_time * (metrics_.total_processed - 1) + processing_time) / metrics_.total_processed;
-                metrics_.operation_counts[operation]++;
+            try {
+                cv::Mat input;
+                std::string error;
+                if (!resolveFrame(request->frame(), &input, &error)) {
+                    response->set_status("error");
+                    response->set_error_message(error);
+                } else {
+                    cv::Mat descriptors = core_.extractDescriptors(input);
+                    size_t added = index_.add(request->image_id(), descriptors);
+                    response->set_descriptor_count(added);
+                    response->set_status("success");
+                    recordProcessing("index_image", msSince(start));
+                }
+            } catch (const std::exception& e) {
+                // Same barrier as processRequest: never let a cv::Exception
+                // escape a pool task
+                response->set_status("error");
+                response->set_error_message(e.what());
             }
-        }
+            admission_.release(msSince(start));
+            reactor->Finish(Status::OK);
+        });
+        return reactor;
+    }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        double total_time = std::chrono::duration<double, std::milli>(end - start).count();
-        response->set_total_time(total_time);
+    grpc::ServerUnaryReactor* QueryNearest(CallbackServerContext* context,
+                                           const QueryRequest* request,
+                                           QueryResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        if (!admission_.enqueue()) {
+            reactor->Finish(shedStatus(context));
+            return reactor;
+        }
+        auto queued_at = std::chrono::steady_clock::now();
+        pool_.submit([this, context, request, response, reactor, queued_at] {
+            if (!admission_.begin(msSince(queued_at))) {
+                reactor->Finish(shedStatus(context));
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
 
-        return Status::OK;
+            try {
+                cv::Mat input;
+                std::string error;
+                if (!resolveFrame(request->frame(), &input, &error)) {
+                    response->set_status("error");
+                    response->set_error_message(error);
+                } else {
+                    size_t max_results = request->max_results() > 0 ? request->max_results() : 5;
+                    cv::Mat descriptors = core_.extractDescriptors(input);
+                    std::vector<DescriptorIndex::Match> matches =
+                        index_.queryNearest(descriptors, max_results);
+                    for (const auto& match : matches) {
+                        DescriptorMatch* out = response->add_matches();
+                        out->set_image_id(match.image_id);
+                        out->set_votes(match.votes);
+                        out->set_score(match.score);
+                    }
+                    response->set_status("success");
+                    recordProcessing("query_nearest", msSince(start));
+                }
+            } catch (const std::exception& e) {
+                response->set_status("error");
+                response->set_error_message(e.what());
+            }
+            admission_.release(msSince(start));
+            reactor->Finish(Status::OK);
+        });
+        return reactor;
     }
 
-    Status GetMetrics(ServerContext* context, const MetricsRequest* request, MetricsResponse* response) override {
-        std::lock_guard<std::mutex> lock(metrics_mutex_);
+    // Runs right on the reactor thread, outside the admission gate:
+    // aggregation is cheap and observability must keep working during
+    // overload
+    grpc::ServerUnaryReactor* GetMetrics(CallbackServerContext* context,
+                                         const MetricsRequest* request,
+                                         MetricsResponse* response) override {
+        ShardedMetrics::Snapshot snapshot = metrics_.aggregate();
+
+        response->set_total_processed(snapshot.total_processed);
+        response->set_average_processing_time(snapshot.average_time_ms);
+        response->set_active_connections(admission_.inFlight());
+        response->set_shed_requests(admission_.shedCount());
+        response->set_simd_tier(ImageCore::simdTier());
+        response->set_backend(core_.activeBackend());
+
+        ImageCore::BackendStats backend_stats = core_.backendStats();
+        response->set_gpu_operations(backend_stats.gpu_ops);
+        response->set_cpu_operations(backend_stats.cpu_ops);
+        response->set_gpu_fallbacks(backend_stats.gpu_fallbacks);
+
+        ArenaAllocator::Stats arena_stats = ArenaAllocator::instance().stats();
+        response->set_arena_allocations(arena_stats.allocations);
+        response->set_arena_pool_hits(arena_stats.pool_hits);
+        response->set_arena_bytes_in_use(arena_stats.bytes_in_use);
 
-        response->set_total_processed(metrics_.total_processed);
-        response->set_average_processing_time(metrics_.average_processing_time);
-        response->set_active_connections(metrics_.active_connections);
+        for (const auto& pair : snapshot.operations) {
+            (*response->mutable_operation_counts())[pair.first] = pair.second.count;
 
-        for (const auto& pair : metrics_.operation_counts) {
-            (*response->mutable_operation_counts())[pair.first] = pair.second;
+            OperationStats& stats = (*response->mutable_operation_stats())[pair.first];
+            stats.set_count(pair.second.count);
+            stats.set_average_time(pair.second.averageMs());
+            stats.set_p50(pair.second.percentileMs(0.50));
+            stats.set_p95(pair.second.percentileMs(0.95));
+            stats.set_p99(pair.second.percentileMs(0.99));
         }
 
-        return Status::OK;
+        // Hierarchical stage timings: "process/invert" nests under the
+        // process node's children map
+        for (const auto& pair : stage_stats_.snapshot()) {
+            const std::string& path = pair.first;
+            auto* level = response->mutable_stage_timings();
+            snapify::StageTiming* node = nullptr;
+            size_t start = 0;
+            while (true) {
+                size_t slash = path.find('/', start);
+                std::string segment = path.substr(
+                    start, slash == std::string::npos ? std::string::npos : slash - start);
+                node = &(*level)[segment];
+                if (slash == std::string::npos) {
+                    break;
+                }
+                level = node->mutable_children();
+                start = slash + 1;
+            }
+            node->set_count(pair.second.count);
+            node->set_total_time(pair.second.total_ms);
+            node->set_average_time(pair.second.averageMs());
+        }
+
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
     }
 };
 
-void RunServer() {
+// Ring size for the shared-memory data plane; enough for a handful of 4K
+// BGRA frames in flight. Pages are committed only when touched.
+static constexpr size_t kDefaultShmBytes = 256 * 1024 * 1024;
+
+// Set by the SIGINT/SIGTERM handler; a watcher thread turns it into a
+// graceful Shutdown so the descriptor index can be persisted
+static std::atomic<bool> g_shutdown_requested{false};
+
+static void handleShutdownSignal(int) {
+    g_shutdown_requested.store(true);
+}
+
+void RunServer(const std::string& backend, const std::string& shm_name, size_t shm_bytes,
+               const std::string& index_path, const ImageServiceImpl::AdmissionConfig& admission,
+               const std::string& trace_path, uint32_t trace_every) {
     std::string server_address("0.0.0.0:50051");
-    ImageServiceImpl service;
+
+    // The server owns the ring lifecycle: created before serving, unlinked
+    // on shutdown. Same-host clients mmap the same name and reference slots
+    // via shm_name/shm_offset in ImageRequest.
+    ShmRegion shm;
+    bool shm_active = !shm_name.empty() && shm.create(shm_name, shm_bytes);
+    if (!shm_name.empty() && !shm_active) {
+        std::cout << "Failed to create shm region " << shm_name << ", inline bytes only" << std::endl;
+    }
+
+    ImageServiceImpl service(backend, shm_active ? &shm : nullptr, index_path, admission);
+    if (!trace_path.empty()) {
+        service.configureTracing(trace_path, trace_every);
+    }
 
     ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
     builder.RegisterService(&service);
 
+    // The callback server runs RPC events on a small fixed set of reactor
+    // threads; all processing happens on the service's worker pool, so gRPC
+    // itself needs only enough threads to keep the network fed regardless of
+    // how many RPCs are in flight
+    constexpr int kReactorThreads = 8;
+    grpc::ResourceQuota quota("snapify_image_service");
+    quota.SetMaxThreads(kReactorThreads);
+    builder.SetResourceQuota(quota);
+
     std::unique_ptr<Server> server(builder.BuildAndStart());
-    std::cout << "C++ gRPC Image Service listening on " << server_address << std::endl;
+    std::cout << "C++ gRPC Image Service listening on " << server_address;
+    if (shm_active) {
+        std::cout << ", shm region " << shm_name << " (" << shm_bytes << " bytes)";
+    }
+    std::cout << std::endl;
+
+    std::signal(SIGINT, handleShutdownSignal);
+    std::signal(SIGTERM, handleShutdownSignal);
+    std::thread watcher([&server] {
+        while (!g_shutdown_requested.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        server->Shutdown();
+    });
 
     server->Wait();
+    g_shutdown_requested.store(true); // stop the watcher on non-signal exits
+    watcher.join();
+    service.saveIndex();
 }
 
 int main(int argc, char** argv) {
-    RunServer();
+    // --backend=cpu|opencl|auto routes the heavy operations; auto uses
+    // OpenCL when a device is present and falls back to CPU otherwise.
+    // --shm-name/--shm-bytes configure the local shared-memory data plane;
+    // --shm-name= (empty) disables it. --index-path persists the descriptor
+    // index across restarts (loaded at startup, saved on clean shutdown).
+    // --max-inflight/--queue-depth/--queue-delay-ms tune admission control:
+    // worker-pool parallelism (0 = core count), how many requests may queue
+    // for a worker, and the queueing deadline past which a request is shed
+    // with RESOURCE_EXHAUSTED.
+    // --trace-path/--trace-every sample one of every N requests' stage trace
+    // into a chrome://tracing JSON file.
+    std::string backend = "auto";
+    std::string shm_name = "/snapify_frames";
+    size_t shm_bytes = kDefaultShmBytes;
+    std::string index_path;
+    ImageServiceImpl::AdmissionConfig admission;
+    std::string trace_path;
+    uint32_t trace_every = 100;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--backend=", 0) == 0) {
+            backend = arg.substr(10);
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (arg.rfind("--shm-name=", 0) == 0) {
+            shm_name = arg.substr(11);
+        } else if (arg.rfind("--shm-bytes=", 0) == 0) {
+            shm_bytes = (size_t)std::stoull(arg.substr(12));
+        } else if (arg.rfind("--index-path=", 0) == 0) {
+            index_path = arg.substr(13);
+        } else if (arg.rfind("--max-inflight=", 0) == 0) {
+            admission.max_inflight = (size_t)std::stoull(arg.substr(15));
+        } else if (arg.rfind("--queue-depth=", 0) == 0) {
+            admission.queue_depth = (size_t)std::stoull(arg.substr(14));
+        } else if (arg.rfind("--queue-delay-ms=", 0) == 0) {
+            admission.max_queue_delay_ms = std::stod(arg.substr(17));
+        } else if (arg.rfind("--trace-path=", 0) == 0) {
+            trace_path = arg.substr(13);
+        } else if (arg.rfind("--trace-every=", 0) == 0) {
+            trace_every = (uint32_t)std::stoul(arg.substr(14));
+        }
+    }
+    RunServer(backend, shm_name, shm_bytes, index_path, admission, trace_path, trace_every);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Runtime dispatcher over the per-tier kernel translation units. The best
+// available tier is selected once per process; tiers with partial coverage
+// fall back per kernel to the next-best implementation.
+#include "simd_kernels.h"
+
+#include "simd_kernel_table.h"
+
+#include <vector>
+
+namespace simd {
+
+namespace {
+
+struct Dispatch {
+    detail::KernelTable table;
+    const char* tier;
+    bool avx2 = false;
+};
+
+// Overlay non-null entries of src onto dst, keeping the previous tier's
+// kernel wherever src has no implementation
+void overlay(detail::KernelTable& dst, const detail::KernelTable& src) {
+    if (src.invert) dst.invert = src.invert;
+    if (src.shuffleBGRA) dst.shuffleBGRA = src.shuffleBGRA;
+    if (src.avgRows) dst.avgRows = src.avgRows;
+}
+
+Dispatch buildDispatch() {
+    Dispatch d;
+    d.table = detail::baselineKernels();
+    d.tier = detail::baselineTierName();
+    if (const detail::KernelTable* neon = detail::neonKernels()) {
+        overlay(d.table, *neon);
+        d.tier = "neon";
+    }
+    if (const detail::KernelTable* avx2 = detail::avx2Kernels()) {
+        overlay(d.table, *avx2);
+        d.tier = "avx2";
+        d.avx2 = true;
+    }
+    if (const detail::KernelTable* avx512 = detail::avx512Kernels()) {
+        overlay(d.table, *avx512);
+        d.tier = "avx512";
+    }
+    return d;
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch d = buildDispatch();
+    return d;
+}
+
+} // namespace
+
+bool avx2Supported() {
+    return dispatch().avx2;
+}
+
+const char* tierName() {
+    return dispatch().tier;
+}
+
+void invert(uint8_t* data, size_t size) {
+    dispatch().table.invert(data, size);
+}
+
+void shuffleBGRA(uint8_t* data, size_t size) {
+    dispatch().table.shuffleBGRA(data, size);
+}
+
+void halve2x2(const uint8_t* src, size_t src_stride, int width, int height,
+              int channels, uint8_t* dst, size_t dst_stride) {
+    const size_t row_bytes = (size_t)width * channels;
+    std::vector<uint8_t> averaged(row_bytes);
+    for (int y = 0; y + 2 <= height; y += 2) {
+        // Vertical half of the 2x2 box filter: byte-parallel, tiered
+        dispatch().table.avgRows(src + (size_t)y * src_stride,
+                                 src + (size_t)(y + 1) * src_stride,
+                                 averaged.data(), row_bytes);
+        // Horizontal half: pair pixels channels bytes apart, so this stays a
+        // scalar loop; the vertical pass above carries the bandwidth
+        uint8_t* out = dst + (size_t)(y / 2) * dst_stride;
+        for (int x = 0; x + 2 <= width; x += 2) {
+            const uint8_t* left = averaged.data() + (size_t)x * channels;
+            for (int c = 0; c < channels; ++c) {
+                out[(size_t)(x / 2) * channels + c] =
+                    (uint8_t)((left[c] + left[channels + c] + 1) >> 1);
+            }
+        }
+    }
+}
+
+} // namespace simd
@@ -0,0 +1,74 @@
+// AVX2/SSSE3 kernel tier. This translation unit is the only one compiled
+// with -mavx2, so these instructions cannot leak into code that runs before
+// the runtime CPU check in avx2Kernels().
+#include "simd_kernel_table.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+namespace detail {
+
+#if defined(__AVX2__)
+
+namespace {
+
+void invertAVX2(uint8_t* data, size_t size) {
+    const __m256i ones = _mm256_set1_epi8((char)0xFF);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(pixels, ones));
+    }
+    invertScalarTail(data + i, size - i);
+}
+
+void avgRowsAVX2(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_avg_epu8(va, vb));
+    }
+    avgRowsScalarTail(a + i, b + i, dst + i, size - i);
+}
+
+void shuffleAVX2(uint8_t* data, size_t size) {
+    const __m256i swap = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(pixels, swap));
+    }
+    shuffleScalarTail(data + i, size - i);
+}
+
+} // namespace
+
+const KernelTable* avx2Kernels() {
+    if (!__builtin_cpu_supports("avx2")) {
+        return nullptr;
+    }
+    static const KernelTable table = [] {
+        KernelTable t;
+        t.invert = invertAVX2;
+        t.shuffleBGRA = shuffleAVX2;
+        t.avgRows = avgRowsAVX2;
+        return t;
+    }();
+    return &table;
+}
+
+#else // !__AVX2__
+
+const KernelTable* avx2Kernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace detail
+} // namespace simd
@@ -0,0 +1,73 @@
+// AVX-512BW kernel tier: 64-byte lanes for the byte-parallel kernels. This
+// translation unit is the only one compiled with -mavx512f -mavx512bw; the
+// runtime check in avx512Kernels() gates it on older CPUs.
+#include "simd_kernel_table.h"
+
+#if defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+namespace detail {
+
+#if defined(__AVX512BW__)
+
+namespace {
+
+void invertAVX512(uint8_t* data, size_t size) {
+    const __m512i ones = _mm512_set1_epi8((char)0xFF);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i pixels = _mm512_loadu_si512(data + i);
+        _mm512_storeu_si512(data + i, _mm512_xor_si512(pixels, ones));
+    }
+    invertScalarTail(data + i, size - i);
+}
+
+void avgRowsAVX512(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(dst + i, _mm512_avg_epu8(va, vb));
+    }
+    avgRowsScalarTail(a + i, b + i, dst + i, size - i);
+}
+
+void shuffleAVX512(uint8_t* data, size_t size) {
+    const __m512i swap = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i pixels = _mm512_loadu_si512(data + i);
+        _mm512_storeu_si512(data + i, _mm512_shuffle_epi8(pixels, swap));
+    }
+    shuffleScalarTail(data + i, size - i);
+}
+
+} // namespace
+
+const KernelTable* avx512Kernels() {
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw")) {
+        return nullptr;
+    }
+    static const KernelTable table = [] {
+        KernelTable t;
+        t.invert = invertAVX512;
+        t.shuffleBGRA = shuffleAVX512;
+        t.avgRows = avgRowsAVX512;
+        return t;
+    }();
+    return &table;
+}
+
+#else // !__AVX512BW__
+
+const KernelTable* avx512Kernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace detail
+} // namespace simd
@@ -0,0 +1,68 @@
+// NEON kernel tier for AArch64 (Graviton and friends). NEON is part of the
+// AArch64 baseline, so no runtime check is needed — the tier is simply
+// compiled out on other targets. vld4/vst4 do the channel deinterleave in
+// hardware, which makes these kernels far simpler than their x86 cousins.
+#include "simd_kernel_table.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+namespace detail {
+
+#if defined(__aarch64__)
+
+namespace {
+
+void invertNEON(uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(data + i, vmvnq_u8(vld1q_u8(data + i)));
+    }
+    invertScalarTail(data + i, size - i);
+}
+
+void avgRowsNEON(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    }
+    avgRowsScalarTail(a + i, b + i, dst + i, size - i);
+}
+
+void shuffleNEON(uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint8x16x4_t px = vld4q_u8(data + i);
+        uint8x16_t tmp = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = tmp;
+        vst4q_u8(data + i, px);
+    }
+    shuffleScalarTail(data + i, size - i);
+}
+
+} // namespace
+
+const KernelTable* neonKernels() {
+    static const KernelTable table = [] {
+        KernelTable t;
+        t.invert = invertNEON;
+        t.shuffleBGRA = shuffleNEON;
+        t.avgRows = avgRowsNEON;
+        return t;
+    }();
+    return &table;
+}
+
+#else // !__aarch64__
+
+const KernelTable* neonKernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace detail
+} // namespace simd
@@ -0,0 +1,111 @@
+// Baseline kernel tier: compiled with no extra instruction-set flags, so it
+// is safe on every CPU the build targets. On x86-64 that baseline includes
+// SSE2, which we use for the byte-parallel kernels; elsewhere these are the
+// plain scalar loops. Also exports the scalar tail helpers the wider tiers
+// use for trailing bytes.
+#include "simd_kernel_table.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#endif
+
+namespace simd {
+namespace detail {
+
+void invertScalarTail(uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = 255 - data[i];
+    }
+}
+
+void shuffleScalarTail(uint8_t* data, size_t size) {
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+        uint8_t tmp = data[i];
+        data[i] = data[i + 2];
+        data[i + 2] = tmp;
+    }
+}
+
+void avgRowsScalarTail(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = (uint8_t)((a[i] + b[i] + 1) >> 1);
+    }
+}
+
+namespace {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+void invertSSE2(uint8_t* data, size_t size) {
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(pixels, ones));
+    }
+    invertScalarTail(data + i, size - i);
+}
+
+// SSE2 has no byte shuffle; swap bytes 0 and 2 of each 4-byte pixel with
+// masks and 32-bit shifts instead
+void shuffleSSE2(uint8_t* data, size_t size) {
+    const __m128i keep = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0x000000FF);
+    const __m128i high = _mm_set1_epi32(0x00FF0000);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i swapped = _mm_or_si128(
+            _mm_and_si128(v, keep),
+            _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, low), 16),
+                         _mm_srli_epi32(_mm_and_si128(v, high), 16)));
+        _mm_storeu_si128((__m128i*)(data + i), swapped);
+    }
+    shuffleScalarTail(data + i, size - i);
+}
+
+// Rounding byte average of two rows — the vertical half of the 2x2 box
+// filter used by the halving downscale
+void avgRowsSSE2(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu8(va, vb));
+    }
+    avgRowsScalarTail(a + i, b + i, dst + i, size - i);
+}
+
+#endif // x86
+
+KernelTable makeBaseline() {
+    KernelTable table;
+#if defined(__x86_64__) || defined(__i386__)
+    table.invert = invertSSE2;
+    table.shuffleBGRA = shuffleSSE2;
+    table.avgRows = avgRowsSSE2;
+#else
+    table.invert = invertScalarTail;
+    table.shuffleBGRA = shuffleScalarTail;
+    table.avgRows = avgRowsScalarTail;
+#endif
+    return table;
+}
+
+} // namespace
+
+const KernelTable& baselineKernels() {
+    static const KernelTable table = makeBaseline();
+    return table;
+}
+
+const char* baselineTierName() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace detail
+} // namespace simd
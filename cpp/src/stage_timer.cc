@@ -0,0 +1,139 @@
+#include "stage_timer.h"
+
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+// Thread-local active trace: set by the boundary layers, read by the core's
+// per-operation scopes
+thread_local StageTrace* t_current_trace = nullptr;
+
+std::chrono::steady_clock::time_point processEpoch() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return epoch;
+}
+
+// Span paths and request names embed client-controlled operation strings;
+// escape them so a quote or backslash in a name cannot corrupt the trace
+std::string escapeJson(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (char c : in) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+double StageTrace::nowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                     processEpoch())
+        .count();
+}
+
+StageTrace* StageTrace::current() {
+    return t_current_trace;
+}
+
+StageTrace::Activate::Activate(StageTrace* trace) : previous_(t_current_trace) {
+    t_current_trace = trace;
+}
+
+StageTrace::Activate::~Activate() {
+    t_current_trace = previous_;
+}
+
+StageTrace::Scope::Scope(StageTrace* trace, const std::string& name) : trace_(trace) {
+    if (trace_ == nullptr) {
+        return;
+    }
+    parent_length_ = trace_->path_.size();
+    if (!trace_->path_.empty()) {
+        trace_->path_ += '/';
+    }
+    trace_->path_ += name;
+    start_ms_ = nowMs();
+}
+
+StageTrace::Scope::~Scope() {
+    if (trace_ == nullptr) {
+        return;
+    }
+    Span span;
+    span.path = trace_->path_;
+    span.start_ms = start_ms_;
+    span.duration_ms = nowMs() - start_ms_;
+    trace_->spans_.push_back(std::move(span));
+    trace_->path_.resize(parent_length_);
+}
+
+void StageStats::record(const StageTrace& trace) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& span : trace.spans()) {
+        Entry& entry = entries_[span.path];
+        entry.count++;
+        entry.total_ms += span.duration_ms;
+    }
+}
+
+std::map<std::string, StageStats::Entry> StageStats::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_;
+}
+
+void TraceSink::configure(const std::string& path, uint32_t sample_every) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    path_ = path;
+    sample_every_ = path.empty() ? 0 : sample_every;
+    header_written_ = false;
+}
+
+bool TraceSink::shouldSample() {
+    if (sample_every_ == 0) {
+        return false;
+    }
+    return counter_.fetch_add(1, std::memory_order_relaxed) % sample_every_ == 0;
+}
+
+void TraceSink::write(const StageTrace& trace, const std::string& request_name) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (sample_every_ == 0) {
+        return;
+    }
+    // Append "X" (complete) events; chrome://tracing and Perfetto accept an
+    // unterminated JSON array, so the file is loadable at any point
+    FILE* out = std::fopen(path_.c_str(), header_written_ ? "a" : "w");
+    if (out == nullptr) {
+        return;
+    }
+    if (!header_written_) {
+        std::fputs("[\n", out);
+        header_written_ = true;
+    }
+    auto tid = (unsigned long)std::hash<std::thread::id>{}(std::this_thread::get_id());
+    const std::string cat = escapeJson(request_name);
+    for (const auto& span : trace.spans()) {
+        std::fprintf(out,
+                     "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.1f,"
+                     "\"dur\":%.1f,\"pid\":1,\"tid\":%lu},\n",
+                     escapeJson(span.path).c_str(), cat.c_str(), span.start_ms * 1000.0,
+                     span.duration_ms * 1000.0, tid);
+    }
+    std::fclose(out);
+}